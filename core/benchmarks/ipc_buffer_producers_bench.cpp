@@ -0,0 +1,118 @@
+#include "shmipc/ipc_buffer.h"
+#include "shmipc/ipc_common.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Throughput of N producers feeding one consumer across the buffer modes:
+// default MPMC (tail lock), IPC_BUFFER_CONCURRENT_WRITE and IPC_BUFFER_MPSC
+// with either producer protocol.
+//
+//   bazel run -c opt //core/benchmarks:ipc_buffer_producers_bench [messages]
+
+namespace {
+constexpr size_t BUFFER_CAPACITY = 1 << 20;
+constexpr size_t MESSAGE_SIZE = 64;
+constexpr size_t PRODUCER_COUNTS[] = {1, 2, 4, 8, 16};
+
+struct Mode {
+  const char *name;
+  uint32_t flags;
+};
+
+constexpr Mode MODES[] = {
+    {"tail-lock", 0},
+    {"concurrent", IPC_BUFFER_CONCURRENT_WRITE},
+    {"mpsc", IPC_BUFFER_MPSC},
+    {"mpsc-conc", IPC_BUFFER_MPSC | IPC_BUFFER_CONCURRENT_WRITE},
+};
+
+struct RunResult {
+  double seconds;
+  size_t messages;
+  uint64_t retries;
+};
+
+RunResult run(uint32_t flags, size_t producers, size_t messages) {
+  std::vector<uint8_t> mem(ipc_buffer_suggest_size(BUFFER_CAPACITY));
+  const IpcBufferOptions options = {.flags = flags, .subscribers = 0};
+  const IpcBufferCreateResult created =
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &options);
+  if (IpcBufferCreateResult_is_error(created)) {
+    std::fprintf(stderr, "create failed: %s\n", created.error.detail);
+    std::exit(1);
+  }
+  IpcBuffer *buffer = created.result;
+
+  const size_t per_producer = messages / producers;
+  const size_t total = per_producer * producers;
+  std::atomic<uint64_t> retries{0};
+  std::atomic<bool> go{false};
+
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; p++) {
+    threads.emplace_back([&, p]() {
+      uint8_t message[MESSAGE_SIZE];
+      memset(message, (int)p, sizeof(message));
+      uint64_t local_retries = 0;
+      while (!go.load(std::memory_order_acquire)) {
+      }
+
+      for (size_t i = 0; i < per_producer;) {
+        memcpy(message, &i, sizeof(i));
+        if (ipc_buffer_write(buffer, message, sizeof(message)).ipc_status ==
+            IPC_OK) {
+          i++;
+        } else {
+          local_retries++;
+        }
+      }
+      retries.fetch_add(local_retries);
+    });
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+
+  uint8_t payload[MESSAGE_SIZE];
+  size_t received = 0;
+  while (received < total) {
+    IpcEntry entry = {.offset = 0, .payload = payload, .size = sizeof(payload)};
+    if (ipc_buffer_read(buffer, &entry).ipc_status == IPC_OK) {
+      received++;
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  for (auto &t : threads) {
+    t.join();
+  }
+  free(buffer);
+
+  return {std::chrono::duration<double>(end - start).count(), total,
+          retries.load()};
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  const size_t messages =
+      argc > 1 ? (size_t)std::strtoull(argv[1], nullptr, 10) : 2000000;
+
+  std::printf("%-12s %9s %12s %14s\n", "mode", "producers", "Mmsg/s",
+              "write retries");
+  for (const size_t producers : PRODUCER_COUNTS) {
+    for (const Mode &mode : MODES) {
+      const RunResult result = run(mode.flags, producers, messages);
+      std::printf("%-12s %9zu %12.2f %14llu\n", mode.name, producers,
+                  result.messages / result.seconds / 1e6,
+                  (unsigned long long)result.retries);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,198 @@
+#include "shmipc/ipc_buffer.h"
+#include "shmipc/ipc_channel.h"
+#include "shmipc/ipc_common.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Latency of one uncontended read of an allocated payload, buffer filled
+// ahead of each round so only the consumer side is timed:
+//   peek-peek-read  the former ipc_channel_read path rebuilt on the buffer
+//                   API: the head is claimed three times (two peeks, the
+//                   read), each a lock and an unlock CAS and a header check
+//   read-sized      ipc_buffer_read_sized, claimed once
+//   channel-*       ipc_channel_read with malloc and with a payload pool,
+//                   and ipc_channel_read_into without any allocation
+//
+//   bazel run -c opt //core/benchmarks:ipc_channel_read_bench [messages]
+
+namespace {
+constexpr size_t BUFFER_CAPACITY = 1 << 20;
+constexpr size_t MESSAGE_SIZE = 64;
+constexpr struct timespec TIMEOUT = {.tv_sec = 1, .tv_nsec = 0};
+
+using Clock = std::chrono::steady_clock;
+
+void *malloc_sizer(size_t size, void *) { return malloc(size); }
+
+template <typename Fill, typename Read>
+double run(size_t messages, Fill fill, Read read) {
+  double seconds = 0;
+  size_t done = 0;
+  while (done < messages) {
+    const size_t round = fill(messages - done);
+    const auto start = Clock::now();
+    for (size_t i = 0; i < round; i++) {
+      read();
+    }
+    seconds += std::chrono::duration<double>(Clock::now() - start).count();
+    done += round;
+  }
+
+  return seconds * 1e9 / (double)done;
+}
+
+IpcBuffer *create_buffer(std::vector<uint8_t> &mem) {
+  mem.resize(ipc_buffer_suggest_size(BUFFER_CAPACITY));
+  const IpcBufferCreateResult created =
+      ipc_buffer_create(mem.data(), mem.size());
+  if (IpcBufferCreateResult_is_error(created)) {
+    std::fprintf(stderr, "create failed: %s\n", created.error.detail);
+    std::exit(1);
+  }
+
+  return created.result;
+}
+
+IpcChannel *create_channel(std::vector<uint8_t> &mem) {
+  mem.resize(ipc_channel_suggest_size(BUFFER_CAPACITY));
+  const IpcChannelOpenResult created =
+      ipc_channel_create(mem.data(), mem.size());
+  if (IpcChannelOpenResult_is_error(created)) {
+    std::fprintf(stderr, "create failed: %s\n", created.error.detail);
+    std::exit(1);
+  }
+
+  return created.result;
+}
+
+void fail(const char *what) {
+  std::fprintf(stderr, "%s failed\n", what);
+  std::exit(1);
+}
+
+double bench_peek_peek_read(size_t messages) {
+  std::vector<uint8_t> mem;
+  IpcBuffer *buffer = create_buffer(mem);
+  const uint8_t message[MESSAGE_SIZE] = {1};
+  const auto fill = [&](size_t left) {
+    size_t count = 0;
+    while (count < left && ipc_buffer_write(buffer, message, sizeof(message))
+                                   .ipc_status == IPC_OK) {
+      count++;
+    }
+    return count;
+  };
+  const auto read = [&]() {
+    IpcEntry peeked;
+    if (ipc_buffer_peek(buffer, &peeked).ipc_status != IPC_OK ||
+        ipc_buffer_peek(buffer, &peeked).ipc_status != IPC_OK) {
+      fail("peek");
+    }
+    IpcEntry entry = {
+        .offset = 0, .payload = malloc(peeked.size), .size = peeked.size};
+    if (ipc_buffer_read(buffer, &entry).ipc_status != IPC_OK) {
+      fail("read");
+    }
+    free(entry.payload);
+  };
+
+  const double ns = run(messages, fill, read);
+  free(buffer);
+  return ns;
+}
+
+double bench_read_sized(size_t messages) {
+  std::vector<uint8_t> mem;
+  IpcBuffer *buffer = create_buffer(mem);
+  const uint8_t message[MESSAGE_SIZE] = {1};
+  const auto fill = [&](size_t left) {
+    size_t count = 0;
+    while (count < left && ipc_buffer_write(buffer, message, sizeof(message))
+                                   .ipc_status == IPC_OK) {
+      count++;
+    }
+    return count;
+  };
+  const auto read = [&]() {
+    IpcEntry entry = {.offset = 0, .payload = nullptr, .size = 0};
+    if (ipc_buffer_read_sized(buffer, &entry, malloc_sizer, nullptr)
+            .ipc_status != IPC_OK) {
+      fail("read sized");
+    }
+    free(entry.payload);
+  };
+
+  const double ns = run(messages, fill, read);
+  free(buffer);
+  return ns;
+}
+
+enum class ChannelRead { MALLOC, POOL, INTO };
+
+double bench_channel(size_t messages, ChannelRead kind) {
+  std::vector<uint8_t> mem;
+  IpcChannel *channel = create_channel(mem);
+  if (kind == ChannelRead::POOL &&
+      ipc_channel_enable_payload_pool(channel, 64).ipc_status != IPC_OK) {
+    fail("enable payload pool");
+  }
+
+  const uint8_t message[MESSAGE_SIZE] = {1};
+  const auto fill = [&](size_t left) {
+    size_t count = 0;
+    while (count < left && ipc_channel_write(channel, message, sizeof(message))
+                                   .ipc_status == IPC_OK) {
+      count++;
+    }
+    return count;
+  };
+  uint8_t buf[MESSAGE_SIZE];
+  const auto read = [&]() {
+    if (kind == ChannelRead::INTO) {
+      size_t len;
+      if (ipc_channel_read_into(channel, buf, sizeof(buf), &len, &TIMEOUT)
+              .ipc_status != IPC_OK) {
+        fail("read into");
+      }
+      return;
+    }
+
+    IpcEntry entry;
+    if (ipc_channel_read(channel, &entry, &TIMEOUT).ipc_status != IPC_OK) {
+      fail("channel read");
+    }
+    if (kind == ChannelRead::POOL) {
+      ipc_entry_release(&entry);
+    } else {
+      free(entry.payload);
+    }
+  };
+
+  const double ns = run(messages, fill, read);
+  ipc_channel_destroy(channel);
+  return ns;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  const size_t messages =
+      argc > 1 ? (size_t)std::strtoull(argv[1], nullptr, 10) : 2000000;
+
+  std::printf("%-16s %12s %10s\n", "path", "head claims", "ns/read");
+  std::printf("%-16s %12d %10.1f\n", "peek-peek-read", 3,
+              bench_peek_peek_read(messages));
+  std::printf("%-16s %12d %10.1f\n", "read-sized", 1,
+              bench_read_sized(messages));
+  std::printf("%-16s %12d %10.1f\n", "channel-malloc", 1,
+              bench_channel(messages, ChannelRead::MALLOC));
+  std::printf("%-16s %12d %10.1f\n", "channel-pool", 1,
+              bench_channel(messages, ChannelRead::POOL));
+  std::printf("%-16s %12d %10.1f\n", "channel-into", 1,
+              bench_channel(messages, ChannelRead::INTO));
+
+  return 0;
+}
@@ -13,36 +13,139 @@
 #define UNLOCK(offset) (((offset) & (~(0x1))))
 #define LOCK(offset) ((offset) | 0x1)
 
+#define SUPPORTED_FLAGS                                                        \
+  (IPC_BUFFER_CONCURRENT_WRITE | IPC_BUFFER_SPSC | IPC_BUFFER_MPSC |           \
+   IPC_BUFFER_COMPACT_ENTRIES | IPC_BUFFER_MIRRORED | IPC_BUFFER_BROADCAST |  \
+   IPC_BUFFER_OVERWRITE)
+// never equal to an entry offset, offsets are always aligned
+#define POISON_BYTE 0xFF
+
+// compact stamp: offset tag in the high half, length in the low half
+#define COMPACT_TAG(offset) ((uint32_t)((offset) >> 3))
+#define COMPACT_PLACEHOLDER 0x80000000u
+#define COMPACT_MAX_DATA_SIZE ((uint64_t)COMPACT_PLACEHOLDER)
+#define COMPACT_POISON UINT64_MAX
+
+// never a valid cursor, cursors are even
+#define CURSOR_FREE UINT64_MAX
+#define NOT_SUBSCRIBED_ERROR_MESSAGE                                           \
+  "illegal state: broadcast reader is not subscribed"
+
 typedef struct IpcBufferHeader {
-  _Atomic uint64_t head;
   _Atomic uint64_t data_size;
-  uint8_t _r_padding[64 - 2 * sizeof(uint64_t)];
+  uint64_t flags;
+  uint64_t subscribers;
+  // serializes group creation and the last member leaving
+  _Atomic uint32_t groups_lock;
+  uint8_t _c_padding[64 - 3 * sizeof(uint64_t) - sizeof(uint32_t)];
+
+  _Atomic uint64_t head;
+  uint8_t _r_padding[64 - sizeof(uint64_t)];
 
   _Atomic uint64_t tail;
-  uint8_t _w_padding[64 - sizeof(uint64_t)];
+  // entries the writer dropped unread, IPC_BUFFER_OVERWRITE only
+  _Atomic uint64_t overwritten;
+  uint8_t _w_padding[64 - 2 * sizeof(uint64_t)];
 } IpcBufferHeader;
 
+// broadcast subscriber head, CURSOR_FREE while the slot is unclaimed. A
+// group slot carries its name, an anonymous subscriber has an empty one.
+typedef struct IpcCursor {
+  _Atomic uint64_t head;
+  uint32_t members;
+  uint8_t _padding[64 - sizeof(uint64_t) - sizeof(uint32_t) -
+                   IPC_BUFFER_GROUP_NAME_MAX];
+  char name[IPC_BUFFER_GROUP_NAME_MAX];
+} IpcCursor;
+
 struct IpcBuffer {
   IpcBufferHeader *header;
   uint8_t *data;
+  uint64_t data_size;
+  uint32_t flags;
+  uint32_t entry_header_size;
+  // consumer cursor: the shared head, or the claimed slot of a broadcast
+  // subscriber, NULL until subscribed
+  _Atomic uint64_t *head;
+  IpcCursor *cursors;
+  IpcCursor *subscription;
+  uint32_t subscribers;
+  // last observed opposite cursors, reloaded only when the ring looks full
+  // (cached_head) or empty (cached_tail); both cursors only move forward, so
+  // a stale value is on the safe side as long as cached_head never goes back
+  _Atomic uint64_t cached_head;
+  _Atomic uint64_t cached_tail;
+  // header->overwritten as of the last read through this handle
+  uint64_t overwritten_seen;
 };
 
 typedef struct EntryHeader {
-  uint64_t seq;
+  _Atomic uint64_t seq;
   uint64_t payload_size;
   uint64_t entry_size;
 } EntryHeader;
 
+typedef struct CompactEntryHeader {
+  _Atomic uint64_t stamp;
+} CompactEntryHeader;
+
+// decoded header, independent of the layout in memory
+typedef struct EntryInfo {
+  uint64_t payload_size;
+  uint64_t entry_size;
+} EntryInfo;
+
 static uint64_t _read_head(const struct IpcBuffer *buffer);
+static uint64_t _gate_head(const struct IpcBuffer *buffer, const uint64_t tail);
+static bool _is_broadcast(const struct IpcBuffer *buffer);
+static void _bind_layout(struct IpcBuffer *buffer, void *mem);
+static bool _claim_cursor(struct IpcBuffer *buffer, IpcCursor *cursor);
+static void _lock_groups(struct IpcBuffer *buffer);
+static void _unlock_groups(struct IpcBuffer *buffer);
 static bool _is_aligned(const uint64_t offset);
 static bool _lock(_Atomic uint64_t *ref, const uint64_t offset);
 static bool _unlock(_Atomic uint64_t *ref, const uint64_t offset);
 static bool _is_locked(const uint64_t offset);
-static IpcStatus _read_entry_header_unsafe(const struct IpcBuffer *buffer,
-                                           const uint64_t offset,
-                                           EntryHeader **dest);
-static IpcStatus _read_entry_header(const struct IpcBuffer *buffer,
-                                    const uint64_t offset, EntryHeader *dest);
+static IpcStatus _read_entry_header_unsafe(struct IpcBuffer *buffer,
+                                           const uint64_t offset);
+static IpcStatus _read_entry_header(struct IpcBuffer *buffer,
+                                    const uint64_t offset, EntryInfo *dest);
+static bool _load_entry(const struct IpcBuffer *buffer, const uint64_t offset,
+                        EntryInfo *dest);
+static uint64_t _entry_size(const struct IpcBuffer *buffer,
+                            const uint64_t payload_size);
+static uint8_t *_payload_at(const struct IpcBuffer *buffer,
+                            const uint64_t offset);
+static bool _is_concurrent_write(const struct IpcBuffer *buffer);
+static bool _is_single_producer(const struct IpcBuffer *buffer);
+static bool _is_single_consumer(const struct IpcBuffer *buffer);
+static bool _lock_head(struct IpcBuffer *buffer, const uint64_t head);
+static bool _unlock_head(struct IpcBuffer *buffer, const uint64_t head);
+static bool _lock_tail(struct IpcBuffer *buffer, const uint64_t tail);
+static bool _unlock_tail(struct IpcBuffer *buffer, const uint64_t tail);
+static bool _advance_tail(struct IpcBuffer *buffer, const uint64_t tail,
+                          const uint64_t new_tail);
+static uint64_t _free_space(struct IpcBuffer *buffer, const uint64_t tail,
+                            const uint64_t required);
+static void _cache_head(struct IpcBuffer *buffer, const uint64_t head);
+static void _publish_entry(struct IpcBuffer *buffer, const uint64_t offset,
+                           const uint64_t payload_size,
+                           const uint64_t entry_size);
+static bool _release_head(struct IpcBuffer *buffer, const uint64_t head,
+                          const uint64_t entry_size);
+static size_t _plan_batch(struct IpcBuffer *buffer, const uint64_t tail,
+                          const IpcMessage *messages, const size_t count,
+                          uint64_t *batch_size);
+static bool _needs_placeholder(const struct IpcBuffer *buffer,
+                               const uint64_t space_to_wrap,
+                               const uint64_t entry_size);
+static bool _is_overwrite(const struct IpcBuffer *buffer);
+static void _evict(struct IpcBuffer *buffer, const uint64_t tail,
+                   const uint64_t required);
+static bool _overrun(const struct IpcBuffer *buffer, const uint64_t head);
+static uint64_t _take_overwritten(struct IpcBuffer *buffer);
+static IpcBufferReadResult _read(IpcBuffer *buffer, IpcEntry *dest,
+                                 IpcPayloadSizer sizer, void *ctx);
 
 inline uint64_t ipc_buffer_get_memory_overhead(void) {
   return BUFFER_HEADER_SIZE_ALIGNED; // TODO: rename to min size
@@ -52,6 +155,23 @@ inline uint64_t ipc_buffer_get_min_size(void) {
   return BUFFER_HEADER_SIZE_ALIGNED + IPC_DATA_ALIGN;
 }
 
+uint64_t
+ipc_buffer_get_memory_overhead_with_options(const IpcBufferOptions *options) {
+  if (options == NULL || (options->flags & IPC_BUFFER_BROADCAST) == 0) {
+    return BUFFER_HEADER_SIZE_ALIGNED;
+  }
+
+  return BUFFER_HEADER_SIZE_ALIGNED +
+         (uint64_t)options->subscribers * sizeof(IpcCursor);
+}
+
+uint64_t ipc_buffer_suggest_size_with_options(size_t desired_capacity,
+                                              const IpcBufferOptions *options) {
+  return ipc_buffer_suggest_size(desired_capacity) -
+         BUFFER_HEADER_SIZE_ALIGNED +
+         ipc_buffer_get_memory_overhead_with_options(options);
+}
+
 uint64_t ipc_buffer_suggest_size(size_t desired_capacity) {
   const uint64_t min_size = ipc_buffer_get_min_size();
   const uint64_t overhead = ipc_buffer_get_memory_overhead();
@@ -65,6 +185,13 @@ uint64_t ipc_buffer_suggest_size(size_t desired_capacity) {
 }
 
 IpcBufferCreateResult ipc_buffer_create(void *mem, const size_t size) {
+  const IpcBufferOptions options = {.flags = 0};
+  return ipc_buffer_create_with_options(mem, size, &options);
+}
+
+IpcBufferCreateResult
+ipc_buffer_create_with_options(void *mem, const size_t size,
+                               const IpcBufferOptions *options) {
   IpcBufferCreateError error = {.requested_size = size,
                                 .min_size = BUFFER_HEADER_SIZE_ALIGNED};
 
@@ -73,18 +200,82 @@ IpcBufferCreateResult ipc_buffer_create(void *mem, const size_t size) {
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: mem is NULL", error);
   }
 
-  if (size < BUFFER_HEADER_SIZE_ALIGNED) {
+  if (options == NULL) {
+    return IpcBufferCreateResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: options is NULL", error);
+  }
+
+  const uint64_t overhead =
+      ipc_buffer_get_memory_overhead_with_options(options);
+  error.min_size = overhead;
+  if (size < overhead) {
     return IpcBufferCreateResult_error_body(
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer size too small",
         error);
   }
 
-  const uint64_t data_capacity = size - BUFFER_HEADER_SIZE_ALIGNED;
+  const uint64_t data_capacity = size - overhead;
   if (!is_power_of_2(data_capacity)) {
     return IpcBufferCreateResult_error_body(IPC_ERR_INVALID_ARGUMENT,
                                             "size must be pover of 2", error);
   }
 
+  if ((options->flags & ~SUPPORTED_FLAGS) != 0) {
+    return IpcBufferCreateResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: unsupported flags", error);
+  }
+
+  if ((options->flags & IPC_BUFFER_CONCURRENT_WRITE) != 0 &&
+      (options->flags & IPC_BUFFER_SPSC) != 0) {
+    return IpcBufferCreateResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: concurrent write requires multiple producers",
+        error);
+  }
+
+  if ((options->flags & IPC_BUFFER_SPSC) != 0 &&
+      (options->flags & IPC_BUFFER_MPSC) != 0) {
+    return IpcBufferCreateResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: SPSC and MPSC are mutually exclusive", error);
+  }
+
+  if (((options->flags & IPC_BUFFER_BROADCAST) != 0) !=
+      (options->subscribers != 0)) {
+    return IpcBufferCreateResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: broadcast requires subscriber slots and vice versa",
+        error);
+  }
+
+  if ((options->flags & IPC_BUFFER_BROADCAST) != 0 &&
+      (options->flags & IPC_BUFFER_CONCURRENT_WRITE) != 0) {
+    // the first subscriber to release an entry would poison it for the rest
+    return IpcBufferCreateResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: broadcast does not support concurrent write",
+        error);
+  }
+
+  if ((options->flags & IPC_BUFFER_OVERWRITE) != 0 &&
+      (options->flags &
+       (IPC_BUFFER_CONCURRENT_WRITE | IPC_BUFFER_BROADCAST)) != 0) {
+    // a poisoning consumer or a lagging subscriber would clobber entries the
+    // writer already reused
+    return IpcBufferCreateResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: overwrite does not support concurrent write or "
+        "broadcast",
+        error);
+  }
+
+  if ((options->flags & IPC_BUFFER_COMPACT_ENTRIES) != 0 &&
+      data_capacity > COMPACT_MAX_DATA_SIZE) {
+    return IpcBufferCreateResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: compact entries limit buffer size to 2 GiB", error);
+  }
+
   struct IpcBuffer *buffer =
       (struct IpcBuffer *)malloc(sizeof(struct IpcBuffer));
   if (buffer == NULL) {
@@ -93,12 +284,30 @@ IpcBufferCreateResult ipc_buffer_create(void *mem, const size_t size) {
         IPC_ERR_SYSTEM, "system error: buffer allocation failed", error);
   }
 
-  buffer->header = (IpcBufferHeader *)mem;
-  buffer->data = ((uint8_t *)mem) + BUFFER_HEADER_SIZE_ALIGNED;
-
-  atomic_init(&buffer->header->data_size, data_capacity);
-  atomic_init(&buffer->header->head, 0);
-  atomic_init(&buffer->header->tail, 0);
+  IpcBufferHeader *header = (IpcBufferHeader *)mem;
+  atomic_init(&header->data_size, data_capacity);
+  atomic_init(&header->head, 0);
+  atomic_init(&header->tail, 0);
+  atomic_init(&header->overwritten, 0);
+  header->flags = options->flags;
+  header->subscribers = options->subscribers;
+  atomic_init(&header->groups_lock, 0);
+
+  _bind_layout(buffer, mem);
+  for (uint32_t i = 0; i < buffer->subscribers; i++) {
+    atomic_init(&buffer->cursors[i].head, CURSOR_FREE);
+    buffer->cursors[i].members = 0;
+    buffer->cursors[i].name[0] = '\0';
+  }
+  atomic_init(&buffer->cached_head, 0);
+  atomic_init(&buffer->cached_tail, 0);
+  buffer->overwritten_seen = 0;
+
+  if (_is_concurrent_write(buffer)) {
+    // entries are published by their seq stamp, so stale bytes must never
+    // look like a valid stamp
+    memset(buffer->data, POISON_BYTE, data_capacity);
+  }
 
   return IpcBufferCreateResult_ok(IPC_OK, buffer);
 }
@@ -119,12 +328,165 @@ IpcBufferAttachResult ipc_buffer_attach(void *mem) {
         IPC_ERR_SYSTEM, "system error: allocation failed", error);
   }
 
-  buffer->header = (IpcBufferHeader *)mem;
-  buffer->data = ((uint8_t *)mem) + BUFFER_HEADER_SIZE_ALIGNED;
+  _bind_layout(buffer, mem);
+  const uint64_t tail = UNLOCK(atomic_load(&buffer->header->tail));
+  atomic_init(&buffer->cached_head, _gate_head(buffer, tail));
+  atomic_init(&buffer->cached_tail, tail);
+  buffer->overwritten_seen = atomic_load(&buffer->header->overwritten);
 
   return IpcBufferAttachResult_ok(IPC_OK, buffer);
 }
 
+IpcBufferAttachResult
+ipc_buffer_attach_with_options(void *mem, const IpcBufferOptions *options) {
+  IpcBufferAttachError error = {.min_size = BUFFER_HEADER_SIZE_ALIGNED};
+  if (mem == NULL) {
+    return IpcBufferAttachResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: mem is NULL", error);
+  }
+
+  if (options == NULL) {
+    return IpcBufferAttachResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: options is NULL", error);
+  }
+
+  const IpcBufferHeader *header = (const IpcBufferHeader *)mem;
+  if (header->flags != options->flags ||
+      header->subscribers != options->subscribers) {
+    return IpcBufferAttachResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: buffer mode mismatch", error);
+  }
+
+  return ipc_buffer_attach(mem);
+}
+
+uint32_t ipc_buffer_get_flags(const IpcBuffer *buffer) {
+  return buffer == NULL ? 0 : buffer->flags;
+}
+
+IpcBufferSubscribeResult ipc_buffer_subscribe(IpcBuffer *buffer) {
+  IpcBufferSubscribeError error = {.subscribers = 0};
+  if (buffer == NULL) {
+    return IpcBufferSubscribeResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is NULL", error);
+  }
+
+  error.subscribers = buffer->subscribers;
+  if (!_is_broadcast(buffer)) {
+    return IpcBufferSubscribeResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is not broadcast",
+        error);
+  }
+
+  if (buffer->head != NULL) {
+    return IpcBufferSubscribeResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: already subscribed", error);
+  }
+
+  for (uint32_t i = 0; i < buffer->subscribers; i++) {
+    if (_claim_cursor(buffer, &buffer->cursors[i])) {
+      return IpcBufferSubscribeResult_ok(IPC_OK, i);
+    }
+  }
+
+  return IpcBufferSubscribeResult_error_body(
+      IPC_ERR_ILLEGAL_STATE, "illegal state: no free subscriber slot", error);
+}
+
+IpcBufferJoinGroupResult ipc_buffer_join_group(IpcBuffer *buffer,
+                                               const char *name) {
+  IpcBufferJoinGroupError error = {.subscribers = 0};
+  if (buffer == NULL) {
+    return IpcBufferJoinGroupResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is NULL", error);
+  }
+
+  if (name == NULL || name[0] == '\0' ||
+      strlen(name) >= IPC_BUFFER_GROUP_NAME_MAX) {
+    return IpcBufferJoinGroupResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: group name is empty or too long", error);
+  }
+
+  error.subscribers = buffer->subscribers;
+  if (!_is_broadcast(buffer)) {
+    return IpcBufferJoinGroupResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is not broadcast",
+        error);
+  }
+
+  if (buffer->head != NULL) {
+    return IpcBufferJoinGroupResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: already subscribed", error);
+  }
+
+  _lock_groups(buffer);
+  for (uint32_t i = 0; i < buffer->subscribers; i++) {
+    IpcCursor *cursor = &buffer->cursors[i];
+    if (atomic_load(&cursor->head) == CURSOR_FREE ||
+        strcmp(cursor->name, name) != 0) {
+      continue;
+    }
+
+    if (_is_single_consumer(buffer)) {
+      _unlock_groups(buffer);
+      return IpcBufferJoinGroupResult_error_body(
+          IPC_ERR_ILLEGAL_STATE,
+          "illegal state: single consumer mode allows one member per group",
+          error);
+    }
+
+    cursor->members++;
+    buffer->head = &cursor->head;
+    buffer->subscription = cursor;
+    _unlock_groups(buffer);
+    return IpcBufferJoinGroupResult_ok(IPC_OK, i);
+  }
+
+  for (uint32_t i = 0; i < buffer->subscribers; i++) {
+    IpcCursor *cursor = &buffer->cursors[i];
+    if (_claim_cursor(buffer, cursor)) {
+      memcpy(cursor->name, name, strlen(name) + 1);
+      cursor->members = 1;
+      _unlock_groups(buffer);
+      return IpcBufferJoinGroupResult_ok(IPC_OK, i);
+    }
+  }
+
+  _unlock_groups(buffer);
+  return IpcBufferJoinGroupResult_error_body(
+      IPC_ERR_ILLEGAL_STATE, "illegal state: no free subscriber slot", error);
+}
+
+IpcBufferUnsubscribeResult ipc_buffer_unsubscribe(IpcBuffer *buffer) {
+  if (buffer == NULL) {
+    return IpcBufferUnsubscribeResult_error(IPC_ERR_INVALID_ARGUMENT,
+                                            "invalid argument: buffer is NULL");
+  }
+
+  if (!_is_broadcast(buffer) || buffer->head == NULL) {
+    return IpcBufferUnsubscribeResult_error(IPC_ERR_ILLEGAL_STATE,
+                                            NOT_SUBSCRIBED_ERROR_MESSAGE);
+  }
+
+  IpcCursor *cursor = buffer->subscription;
+  buffer->head = NULL;
+  buffer->subscription = NULL;
+  if (cursor->name[0] == '\0') {
+    atomic_store(&cursor->head, CURSOR_FREE);
+    return IpcBufferUnsubscribeResult_ok(IPC_OK);
+  }
+
+  _lock_groups(buffer);
+  if (--cursor->members == 0) {
+    cursor->name[0] = '\0';
+    atomic_store(&cursor->head, CURSOR_FREE);
+  }
+  _unlock_groups(buffer);
+
+  return IpcBufferUnsubscribeResult_ok(IPC_OK);
+}
+
 IpcBufferWriteResult ipc_buffer_write(IpcBuffer *buffer, const void *data,
                                       const size_t size) {
   IpcBufferWriteError error = {.offset = 0,
@@ -141,233 +503,736 @@ IpcBufferWriteResult ipc_buffer_write(IpcBuffer *buffer, const void *data,
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: data is NULL", error);
   }
 
+  IpcSlot slot;
+  const IpcBufferReserveResult reserve_result =
+      ipc_buffer_reserve(buffer, size, &slot);
+  if (IpcBufferReserveResult_is_error(reserve_result)) {
+    if (IpcBufferReserveResult_is_error_has_body(reserve_result.error)) {
+      const IpcBufferReserveError b = reserve_result.error.body;
+      error.offset = b.offset;
+      error.required_size = b.required_size;
+      error.free_space = b.free_space;
+      error.available_contiguous = b.available_contiguous;
+      error.buffer_size = b.buffer_size;
+    }
+
+    return IpcBufferWriteResult_error_body(reserve_result.ipc_status,
+                                           reserve_result.error.detail, error);
+  }
+
+  memcpy(slot.payload, data, size);
+
+  const IpcBufferCommitResult commit_result = ipc_buffer_commit(buffer, &slot);
+  if (IpcBufferCommitResult_is_error(commit_result)) {
+    error.offset = slot.offset;
+    return IpcBufferWriteResult_error_body(commit_result.ipc_status,
+                                           commit_result.error.detail, error);
+  }
+
+  return IpcBufferWriteResult_ok(IPC_OK);
+}
+
+IpcBufferWritevResult ipc_buffer_writev(IpcBuffer *buffer,
+                                        const struct iovec *iov,
+                                        const int iovcnt) {
+  IpcBufferWritevError error = {.offset = 0,
+                                .requested_size = 0,
+                                .available_contiguous = 0,
+                                .buffer_size = 0};
+  if (buffer == NULL) {
+    return IpcBufferWritevResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is NULL", error);
+  }
+
+  if (iov == NULL) {
+    return IpcBufferWritevResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: iov is NULL", error);
+  }
+
+  if (iovcnt <= 0) {
+    return IpcBufferWritevResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: iovcnt must be > 0",
+        error);
+  }
+
+  size_t size = 0;
+  for (int i = 0; i < iovcnt; i++) {
+    if (iov[i].iov_base == NULL && iov[i].iov_len != 0) {
+      return IpcBufferWritevResult_error_body(
+          IPC_ERR_INVALID_ARGUMENT, "invalid argument: iov_base is NULL",
+          error);
+    }
+
+    size += iov[i].iov_len;
+  }
+  error.requested_size = size;
+
+  IpcSlot slot;
+  const IpcBufferReserveResult reserve_result =
+      ipc_buffer_reserve(buffer, size, &slot);
+  if (IpcBufferReserveResult_is_error(reserve_result)) {
+    if (IpcBufferReserveResult_is_error_has_body(reserve_result.error)) {
+      const IpcBufferReserveError b = reserve_result.error.body;
+      error.offset = b.offset;
+      error.required_size = b.required_size;
+      error.free_space = b.free_space;
+      error.available_contiguous = b.available_contiguous;
+      error.buffer_size = b.buffer_size;
+    }
+
+    return IpcBufferWritevResult_error_body(reserve_result.ipc_status,
+                                            reserve_result.error.detail, error);
+  }
+
+  uint8_t *dst = (uint8_t *)slot.payload;
+  for (int i = 0; i < iovcnt; i++) {
+    if (iov[i].iov_len != 0) {
+      memcpy(dst, iov[i].iov_base, iov[i].iov_len);
+      dst += iov[i].iov_len;
+    }
+  }
+
+  const IpcBufferCommitResult commit_result = ipc_buffer_commit(buffer, &slot);
+  if (IpcBufferCommitResult_is_error(commit_result)) {
+    error.offset = slot.offset;
+    return IpcBufferWritevResult_error_body(commit_result.ipc_status,
+                                            commit_result.error.detail, error);
+  }
+
+  return IpcBufferWritevResult_ok(IPC_OK);
+}
+
+IpcBufferWriteBatchResult ipc_buffer_write_batch(IpcBuffer *buffer,
+                                                 const IpcMessage *messages,
+                                                 const size_t count) {
+  IpcBufferWriteBatchError error = {.offset = 0,
+                                    .index = 0,
+                                    .required_size = 0,
+                                    .free_space = 0,
+                                    .buffer_size = 0};
+  if (buffer == NULL) {
+    return IpcBufferWriteBatchResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is NULL", error);
+  }
+
+  if (messages == NULL) {
+    return IpcBufferWriteBatchResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: messages is NULL", error);
+  }
+
+  if (count == 0) {
+    return IpcBufferWriteBatchResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: messages count is 0",
+        error);
+  }
+
+  struct IpcBuffer *buf = (struct IpcBuffer *)buffer;
+  const uint64_t buf_size = buf->data_size;
+  error.buffer_size = buf_size;
+  for (size_t i = 0; i < count; i++) {
+    error.index = i;
+    if (messages[i].data == NULL) {
+      return IpcBufferWriteBatchResult_error_body(
+          IPC_ERR_INVALID_ARGUMENT, "invalid argument: data is NULL", error);
+    }
+
+    if (messages[i].size == 0) {
+      return IpcBufferWriteBatchResult_error_body(
+          IPC_ERR_INVALID_ARGUMENT, "invalid argument: data size is 0", error);
+    }
+
+    if (_entry_size(buf, messages[i].size) > buf_size) {
+      return IpcBufferWriteBatchResult_error_body(
+          IPC_ERR_ENTRY_TOO_LARGE,
+          "invalid argument: entry size exceeds buffer", error);
+    }
+  }
+  error.index = 0;
+
+  uint64_t tail, batch_size;
+  size_t batch_count;
+  bool claimed = false;
+  do {
+    tail = atomic_load(&buf->header->tail);
+    if (_is_locked(tail)) {
+      return IpcBufferWriteBatchResult_error_body(IPC_ERR_LOCKED, "locked",
+                                                  error);
+    }
+
+    batch_count = _plan_batch(buf, tail, messages, count, &batch_size);
+    if (batch_count == 0 && !_is_overwrite(buf)) {
+      error.offset = tail;
+      error.required_size = _entry_size(buf, messages[0].size);
+      error.free_space = _free_space(buf, tail, buf_size);
+      return IpcBufferWriteBatchResult_error_body(
+          IPC_ERR_NO_SPACE_CONTIGUOUS, "not enough contiguous space in buffer",
+          error);
+    }
+
+    if (_is_concurrent_write(buf)) {
+      uint64_t expected_tail = tail;
+      claimed = atomic_compare_exchange_weak(&buf->header->tail,
+                                             &expected_tail, tail + batch_size);
+    } else {
+      // head only moves forward, so the plan stays valid once tail is ours
+      claimed = _lock_tail(buf, tail);
+    }
+  } while (!claimed);
+
+  if (_is_overwrite(buf)) {
+    _evict(buf, tail, batch_size);
+  }
+
+  if (batch_count == 0) {
+    // the first entry does not fit behind its placeholder in an overwrite
+    // ring, the placeholder goes first on its own as in ipc_buffer_reserve
+    _publish_entry(buf, tail, 0, batch_size);
+    if (!_advance_tail(buf, tail, tail + batch_size)) {
+      error.offset = tail;
+      return IpcBufferWriteBatchResult_error_body(
+          IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected tail offset",
+          error);
+    }
+
+    return ipc_buffer_write_batch(buffer, messages, count);
+  }
+
+  uint64_t offset = tail;
+  for (size_t i = 0; i < batch_count; i++) {
+    const uint64_t entry_size = _entry_size(buf, messages[i].size);
+    const uint64_t rel_offset = RELATIVE(offset, buf_size);
+    const uint64_t space_to_wrap = buf_size - rel_offset;
+    if (rel_offset != 0 &&
+        _needs_placeholder(buf, space_to_wrap, entry_size)) {
+      _publish_entry(buf, offset, 0, space_to_wrap);
+      offset += space_to_wrap;
+    }
+
+    memcpy(_payload_at(buf, offset), messages[i].data, messages[i].size);
+    _publish_entry(buf, offset, messages[i].size, entry_size);
+    offset += entry_size;
+  }
+
+  if (!_is_concurrent_write(buf) &&
+      !_advance_tail(buf, tail, tail + batch_size)) {
+    error.offset = tail;
+    return IpcBufferWriteBatchResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected tail offset", error);
+  }
+
+  return IpcBufferWriteBatchResult_ok(IPC_OK, batch_count);
+}
+
+IpcBufferReserveResult ipc_buffer_reserve(IpcBuffer *buffer, const size_t size,
+                                          IpcSlot *slot) {
+  IpcBufferReserveError error = {.offset = 0,
+                                 .requested_size = size,
+                                 .available_contiguous = 0,
+                                 .buffer_size = 0};
+  if (buffer == NULL) {
+    return IpcBufferReserveResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is NULL", error);
+  }
+
+  if (slot == NULL) {
+    return IpcBufferReserveResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: slot is NULL", error);
+  }
+
   if (size == 0) {
-    return IpcBufferWriteResult_error_body(
+    return IpcBufferReserveResult_error_body(
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: data size is 0", error);
   }
 
-  const uint64_t buf_size =
-      atomic_load(&((struct IpcBuffer *)buffer)->header->data_size);
-  uint64_t full_entry_size =
-      ALIGN_UP(sizeof(EntryHeader) + size, IPC_DATA_ALIGN);
+  const uint64_t buf_size = buffer->data_size;
+  uint64_t full_entry_size = _entry_size(buffer, size);
   if (full_entry_size > buf_size) {
     error.buffer_size = buf_size;
-    return IpcBufferWriteResult_error_body(
+    return IpcBufferReserveResult_error_body(
         IPC_ERR_ENTRY_TOO_LARGE, "invalid argument: entry size exceeds buffer",
         error);
   }
 
   uint64_t tail, rel_tail, space_to_wrap;
   bool placeholder = false;
+  bool claimed = false;
   do {
     tail = atomic_load(&((struct IpcBuffer *)buffer)->header->tail);
     if (_is_locked(tail)) {
-      return IpcBufferWriteResult_error_body(IPC_ERR_LOCKED, "locked", error);
+      return IpcBufferReserveResult_error_body(IPC_ERR_LOCKED, "locked",
+                                               error);
     }
 
     rel_tail = RELATIVE(tail, buf_size);
 
     space_to_wrap = buf_size - rel_tail;
-    const uint64_t head = UNLOCK(_read_head(buffer));
-    const uint64_t used = tail - head;
-    const uint64_t free_space = buf_size - used;
+    const uint64_t free_space =
+        _free_space((struct IpcBuffer *)buffer, tail, full_entry_size);
 
-    if (free_space < full_entry_size) {
+    if (free_space < full_entry_size && !_is_overwrite(buffer)) {
       error.offset = tail;
       error.required_size = (size_t)(full_entry_size);
       error.free_space = (size_t)(free_space);
-      return IpcBufferWriteResult_error_body(
+      return IpcBufferReserveResult_error_body(
           IPC_ERR_NO_SPACE_CONTIGUOUS, "not enough contiguous space in buffer",
           error);
     }
 
     // no space for current entry + header of next placeholder
-    placeholder = space_to_wrap < full_entry_size + sizeof(EntryHeader);
-  } while (!_lock(&((struct IpcBuffer *)buffer)->header->tail, tail));
+    placeholder = _needs_placeholder(buffer, space_to_wrap, full_entry_size);
+
+    if (_is_concurrent_write(buffer)) {
+      // the claim itself is the only shared write, the entry is published
+      // later by its seq stamp
+      uint64_t expected_tail = tail;
+      claimed = atomic_compare_exchange_weak(
+          &((struct IpcBuffer *)buffer)->header->tail, &expected_tail,
+          tail + (placeholder ? space_to_wrap : full_entry_size));
+    } else {
+      claimed = _lock_tail((struct IpcBuffer *)buffer, tail);
+    }
+  } while (!claimed);
+
+  if (_is_overwrite(buffer)) {
+    _evict(buffer, tail, placeholder ? space_to_wrap : full_entry_size);
+  }
+
+  if (placeholder) {
+    _publish_entry(buffer, tail, 0, space_to_wrap);
+
+    if (!_is_concurrent_write(buffer) &&
+        !_advance_tail((struct IpcBuffer *)buffer, tail,
+                       tail + space_to_wrap)) {
+      error.offset = tail;
+      return IpcBufferReserveResult_error_body(
+          IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected tail offset",
+          error);
+    }
+
+    return ipc_buffer_reserve(buffer, size, slot);
+  }
+
+  slot->offset = tail;
+  slot->payload = (void *)_payload_at(buffer, tail);
+  slot->size = size;
+
+  return IpcBufferReserveResult_ok(IPC_OK);
+}
+
+IpcBufferCommitResult ipc_buffer_commit(IpcBuffer *buffer,
+                                        const IpcSlot *slot) {
+  IpcBufferCommitError error = {.offset = 0};
+  if (buffer == NULL) {
+    return IpcBufferCommitResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is NULL", error);
+  }
+
+  if (slot == NULL) {
+    return IpcBufferCommitResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: slot is NULL", error);
+  }
+
+  error.offset = slot->offset;
+  const uint64_t entry_size = _entry_size(buffer, slot->size);
+
+  EntryInfo info;
+  if (_is_concurrent_write(buffer)) {
+    if (_load_entry(buffer, slot->offset, &info)) {
+      return IpcBufferCommitResult_error_body(
+          IPC_ERR_ILLEGAL_STATE, "illegal state: slot is not reserved", error);
+    }
+
+    _publish_entry(buffer, slot->offset, slot->size, entry_size);
+    return IpcBufferCommitResult_ok(IPC_OK);
+  }
+
+  const uint64_t tail =
+      atomic_load(&((struct IpcBuffer *)buffer)->header->tail);
+  const uint64_t reserved_tail =
+      _is_single_producer(buffer) ? slot->offset : LOCK(slot->offset);
+  if (tail != reserved_tail) {
+    return IpcBufferCommitResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: slot is not reserved", error);
+  }
+
+  _publish_entry(buffer, slot->offset, slot->size, entry_size);
+
+  if (!_advance_tail((struct IpcBuffer *)buffer, slot->offset,
+                     slot->offset + entry_size)) {
+    return IpcBufferCommitResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected tail offset", error);
+  }
+
+  return IpcBufferCommitResult_ok(IPC_OK);
+}
+
+IpcBufferAbortResult ipc_buffer_abort(IpcBuffer *buffer, const IpcSlot *slot) {
+  IpcBufferAbortError error = {.offset = 0};
+  if (buffer == NULL) {
+    return IpcBufferAbortResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is NULL", error);
+  }
+
+  if (slot == NULL) {
+    return IpcBufferAbortResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: slot is NULL", error);
+  }
+
+  error.offset = slot->offset;
+  if (_is_concurrent_write(buffer)) {
+    // the region is already claimed, publish it as a placeholder to skip
+    EntryInfo info;
+    if (_load_entry(buffer, slot->offset, &info)) {
+      return IpcBufferAbortResult_error_body(
+          IPC_ERR_ILLEGAL_STATE, "illegal state: slot is not reserved", error);
+    }
+
+    _publish_entry(buffer, slot->offset, 0, _entry_size(buffer, slot->size));
+    return IpcBufferAbortResult_ok(IPC_OK);
+  }
+
+  if (!_unlock_tail((struct IpcBuffer *)buffer, slot->offset)) {
+    return IpcBufferAbortResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: slot is not reserved", error);
+  }
+
+  return IpcBufferAbortResult_ok(IPC_OK);
+}
+
+IpcBufferReadResult ipc_buffer_read(IpcBuffer *buffer, IpcEntry *dest) {
+  return _read(buffer, dest, NULL, NULL);
+}
+
+IpcBufferReadResult ipc_buffer_read_sized(IpcBuffer *buffer, IpcEntry *dest,
+                                          IpcPayloadSizer sizer, void *ctx) {
+  if (sizer == NULL) {
+    const IpcBufferReadError error = {.offset = 0, .required_size = 0};
+    return IpcBufferReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: sizer is NULL", error);
+  }
+
+  return _read(buffer, dest, sizer, ctx);
+}
+
+IpcBufferReadResult ipc_buffer_read_lossy(IpcBuffer *buffer, IpcEntry *dest,
+                                          uint64_t *lost) {
+  if (lost == NULL) {
+    const IpcBufferReadError error = {.offset = 0, .required_size = 0};
+    return IpcBufferReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: lost is NULL", error);
+  }
+
+  const IpcBufferReadResult result = _read(buffer, dest, NULL, NULL);
+  if (IpcBufferReadResult_is_ok(result)) {
+    // taken after the read, an entry lapped during it is counted now
+    *lost = _take_overwritten(buffer);
+  }
+
+  return result;
+}
+
+IpcBufferReadBatchResult ipc_buffer_read_batch(IpcBuffer *buffer,
+                                               const size_t max_entries,
+                                               IpcEntryCallback callback,
+                                               void *ctx) {
+  IpcBufferReadBatchError error = {.offset = 0};
+  if (buffer == NULL) {
+    return IpcBufferReadBatchResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is NULL", error);
+  }
+
+  if (callback == NULL) {
+    return IpcBufferReadBatchResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: callback is NULL", error);
+  }
+
+  if (max_entries == 0) {
+    return IpcBufferReadBatchResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: max_entries is 0", error);
+  }
+
+  if (_is_overwrite((struct IpcBuffer *)buffer)) {
+    // the writer reuses the bytes under the callback
+    return IpcBufferReadBatchResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: buffer is overwrite, read_batch hands out views",
+        error);
+  }
+
+  if (buffer->head == NULL) {
+    return IpcBufferReadBatchResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, NOT_SUBSCRIBED_ERROR_MESSAGE, error);
+  }
+
+  struct IpcBuffer *buf = (struct IpcBuffer *)buffer;
+  uint64_t head;
+  do {
+    head = _read_head(buf);
+    if (_is_locked(head)) {
+      error.offset = UNLOCK(head);
+      return IpcBufferReadBatchResult_error_body(IPC_ERR_LOCKED,
+                                                 "entry is locked", error);
+    }
+
+  } while (!_lock_head(buf, head));
+
+  uint64_t offset = head;
+  size_t count = 0;
+  IpcStatus status = IPC_OK;
+  while (count < max_entries) {
+    EntryInfo header;
+    status = _read_entry_header(buf, offset, &header);
+    if (status == IPC_PLACEHOLDER) {
+      offset += header.entry_size;
+      continue;
+    }
+
+    if (status != IPC_OK) {
+      break;
+    }
+
+    const IpcEntry entry = {
+        .offset = offset,
+        .payload = _payload_at(buf, offset),
+        .size = header.payload_size};
+    callback(&entry, ctx);
+
+    offset += header.entry_size;
+    count++;
+  }
+
+  // nothing consumed but maybe placeholders, report why the batch is empty
+  if (count == 0 && status != IPC_OK && status != IPC_EMPTY) {
+    if (offset != head ? !_release_head(buf, head, offset - head)
+                       : !_unlock_head(buf, head)) {
+      return IpcBufferReadBatchResult_error_body(
+          IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset",
+          error);
+    }
+
+    error.offset = offset;
+    return IpcBufferReadBatchResult_error_body(status, "unreadable entry state",
+                                               error);
+  }
+
+  if (offset == head) {
+    if (!_unlock_head(buf, head)) {
+      return IpcBufferReadBatchResult_error_body(
+          IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset",
+          error);
+    }
 
-  EntryHeader *header =
-      (EntryHeader *)(((struct IpcBuffer *)buffer)->data + rel_tail);
-  if (placeholder) {
-    header->payload_size = 0;
-    header->entry_size = space_to_wrap;
-  } else {
-    void *dest = (void *)(((uint8_t *)header) + sizeof(EntryHeader));
-    memcpy(dest, data, size);
-    header->entry_size = full_entry_size;
-    header->payload_size = size;
-  }
-  header->seq = tail;
-
-  uint64_t expected_offset = LOCK(tail);
-  if (!atomic_compare_exchange_strong(
-          &((struct IpcBuffer *)buffer)->header->tail, &expected_offset,
-          tail + header->entry_size)) {
-    error.offset = tail;
-    return IpcBufferWriteResult_error_body(
-        IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected tail offset", error);
+    return IpcBufferReadBatchResult_ok(IPC_EMPTY, 0);
   }
 
-  if (placeholder) {
-    return ipc_buffer_write(buffer, data, size);
+  if (!_release_head(buf, head, offset - head)) {
+    return IpcBufferReadBatchResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset", error);
   }
 
-  return IpcBufferWriteResult_ok(IPC_OK);
+  return IpcBufferReadBatchResult_ok(count == 0 ? IPC_EMPTY : IPC_OK, count);
 }
 
-IpcBufferReadResult ipc_buffer_read(IpcBuffer *buffer, IpcEntry *dest) {
-  IpcBufferReadError error = {.offset = 0};
-
+IpcBufferPeekResult ipc_buffer_peek(IpcBuffer *buffer, IpcEntry *dest) {
+  IpcBufferPeekError error = {.offset = 0};
   if (buffer == NULL) {
-    return IpcBufferReadResult_error_body(
+    return IpcBufferPeekResult_error_body(
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is NULL", error);
   }
 
   if (dest == NULL) {
-    return IpcBufferReadResult_error_body(
+    return IpcBufferPeekResult_error_body(
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: dest is NULL", error);
   }
 
+  if (buffer->head == NULL) {
+    return IpcBufferPeekResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, NOT_SUBSCRIBED_ERROR_MESSAGE, error);
+  }
+
+  const bool overwrite = _is_overwrite((struct IpcBuffer *)buffer);
   uint64_t head;
   do {
     head = _read_head(buffer);
     if (_is_locked(head)) {
       error.offset = UNLOCK(head);
-      return IpcBufferReadResult_error_body(IPC_ERR_LOCKED, "entry is locked",
+      return IpcBufferPeekResult_error_body(IPC_ERR_LOCKED, "entry is locked",
                                             error);
     }
 
-  } while (!_lock(&((struct IpcBuffer *)buffer)->header->head, head));
-
-  const size_t dst_cap = dest->size;
-  EntryHeader header;
+  } while (!_lock_head((struct IpcBuffer *)buffer, head));
 
+  EntryInfo header;
   const IpcStatus status =
       _read_entry_header((struct IpcBuffer *)buffer, head, &header);
+  if (overwrite && _overrun(buffer, head)) {
+    // lapped while the header was loaded, like in _read
+    return ipc_buffer_peek(buffer, dest);
+  }
+
   const bool placeholder = status == IPC_PLACEHOLDER;
+
   if (!placeholder && status != IPC_OK) {
-    if (!_unlock(&((struct IpcBuffer *)buffer)->header->head, head)) {
-      return IpcBufferReadResult_error_body(
-          IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset",
-          error);
+    if (!_unlock_head((struct IpcBuffer *)buffer, head)) {
+      return overwrite ? ipc_buffer_peek(buffer, dest)
+                       : IpcBufferPeekResult_error_body(
+                             IPC_ERR_ILLEGAL_STATE,
+                             "illegal state: unexpected head offset", error);
     }
 
     if (status == IPC_EMPTY) {
-      return IpcBufferReadResult_ok(IPC_EMPTY);
+      return IpcBufferPeekResult_ok(IPC_EMPTY);
     }
 
     error.offset = head;
-    return IpcBufferReadResult_error_body(status, "unreadable entry state",
+    return IpcBufferPeekResult_error_body(status, "unreadable entry state",
                                           error);
   }
 
-  const uint64_t rel_offset = RELATIVE(
-      head, atomic_load(&((struct IpcBuffer *)buffer)->header->data_size));
-
-  if (!placeholder) {
-    if (dst_cap < header.payload_size) {
-      error.offset = head;
-      error.required_size = header.payload_size;
-      if (!_unlock(&((struct IpcBuffer *)buffer)->header->head, head)) {
-        return IpcBufferReadResult_error_body(
-            IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset",
-            error);
-      }
-
-      return IpcBufferReadResult_error_body(
-          IPC_ERR_TOO_SMALL, "destination buffer is too small", error);
+  if (placeholder) {
+    if (!_release_head(buffer, head, header.entry_size)) {
+      return overwrite ? ipc_buffer_peek(buffer, dest)
+                       : IpcBufferPeekResult_error_body(
+                             IPC_ERR_ILLEGAL_STATE,
+                             "illegal state: unexpected head offset", error);
     }
 
-    memcpy(dest->payload,
-           ((((struct IpcBuffer *)buffer)->data + rel_offset) +
-            sizeof(EntryHeader)),
-           header.payload_size);
-    dest->offset = head;
-    dest->size = header.payload_size;
+    return ipc_buffer_peek(buffer, dest);
   }
 
-  uint64_t expected_current_head = LOCK(head);
-  if (!atomic_compare_exchange_strong(
-          &((struct IpcBuffer *)buffer)->header->head, &expected_current_head,
-          head + header.entry_size)) {
-    return IpcBufferReadResult_error_body(
-        IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset", error);
+  dest->offset = head;
+  dest->size = header.payload_size;
+
+  // an overwrite ring may reuse the bytes as soon as the head is unlocked
+  dest->payload = overwrite ? NULL : _payload_at(buffer, head);
+
+  if (!_unlock_head((struct IpcBuffer *)buffer, head)) {
+    return overwrite ? ipc_buffer_peek(buffer, dest)
+                     : IpcBufferPeekResult_error_body(
+                           IPC_ERR_ILLEGAL_STATE,
+                           "illegal state: unexpected head offset", error);
   }
 
-  return placeholder ? ipc_buffer_read(buffer, dest)
-                     : IpcBufferReadResult_ok(IPC_OK);
+  return IpcBufferPeekResult_ok(IPC_OK);
 }
 
-IpcBufferPeekResult ipc_buffer_peek(IpcBuffer *buffer, IpcEntry *dest) {
-  IpcBufferPeekError error = {.offset = 0};
+IpcBufferAcquireResult ipc_buffer_acquire(IpcBuffer *buffer, IpcEntry *dest) {
+  IpcBufferAcquireError error = {.offset = 0};
   if (buffer == NULL) {
-    return IpcBufferPeekResult_error_body(
+    return IpcBufferAcquireResult_error_body(
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is NULL", error);
   }
 
   if (dest == NULL) {
-    return IpcBufferPeekResult_error_body(
+    return IpcBufferAcquireResult_error_body(
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: dest is NULL", error);
   }
 
+  if (_is_overwrite((struct IpcBuffer *)buffer)) {
+    // the writer takes the head back from a held entry and reuses its bytes
+    return IpcBufferAcquireResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: buffer is overwrite, acquire hands out views",
+        error);
+  }
+
+  if (buffer->head == NULL) {
+    return IpcBufferAcquireResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, NOT_SUBSCRIBED_ERROR_MESSAGE, error);
+  }
+
   uint64_t head;
   do {
     head = _read_head(buffer);
     if (_is_locked(head)) {
       error.offset = UNLOCK(head);
-      return IpcBufferPeekResult_error_body(IPC_ERR_LOCKED, "entry is locked",
-                                            error);
+      return IpcBufferAcquireResult_error_body(IPC_ERR_LOCKED,
+                                               "entry is locked", error);
     }
 
-  } while (!_lock(&((struct IpcBuffer *)buffer)->header->head, head));
+  } while (!_lock_head((struct IpcBuffer *)buffer, head));
 
-  EntryHeader header;
+  EntryInfo header;
   const IpcStatus status =
       _read_entry_header((struct IpcBuffer *)buffer, head, &header);
   const bool placeholder = status == IPC_PLACEHOLDER;
 
   if (!placeholder && status != IPC_OK) {
-    if (!_unlock(&((struct IpcBuffer *)buffer)->header->head, head)) {
-      return IpcBufferPeekResult_error_body(
+    if (!_unlock_head((struct IpcBuffer *)buffer, head)) {
+      return IpcBufferAcquireResult_error_body(
           IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset",
           error);
     }
 
     if (status == IPC_EMPTY) {
-      return IpcBufferPeekResult_ok(IPC_EMPTY);
+      return IpcBufferAcquireResult_ok(IPC_EMPTY);
     }
 
     error.offset = head;
-    return IpcBufferPeekResult_error_body(status, "unreadable entry state",
-                                          error);
+    return IpcBufferAcquireResult_error_body(status, "unreadable entry state",
+                                             error);
   }
 
   if (placeholder) {
-    uint64_t expected_current_head = LOCK(head);
-    if (!atomic_compare_exchange_strong(
-            &((struct IpcBuffer *)buffer)->header->head, &expected_current_head,
-            head + header.entry_size)) {
-      return IpcBufferPeekResult_error_body(
+    if (!_release_head(buffer, head, header.entry_size)) {
+      return IpcBufferAcquireResult_error_body(
           IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset",
           error);
     }
 
-    return ipc_buffer_peek(buffer, dest);
+    return ipc_buffer_acquire(buffer, dest);
   }
 
+  // the head stays locked until release, nobody can consume or overwrite
+  // the entry in the meantime
   dest->offset = head;
   dest->size = header.payload_size;
+  dest->payload = _payload_at(buffer, head);
 
-  const uint64_t rel_offset = RELATIVE(
-      head, atomic_load(&((struct IpcBuffer *)buffer)->header->data_size));
-  dest->payload =
-      ((((struct IpcBuffer *)buffer)->data + rel_offset) + sizeof(EntryHeader));
+  return IpcBufferAcquireResult_ok(IPC_OK);
+}
 
-  if (!_unlock(&((struct IpcBuffer *)buffer)->header->head, head)) {
-    return IpcBufferPeekResult_error_body(
+IpcBufferReleaseResult ipc_buffer_release(IpcBuffer *buffer,
+                                          const IpcEntry *entry) {
+  IpcBufferReleaseError error = {.offset = 0};
+  if (buffer == NULL) {
+    return IpcBufferReleaseResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is NULL", error);
+  }
+
+  if (entry == NULL) {
+    return IpcBufferReleaseResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: entry is NULL", error);
+  }
+
+  if (buffer->head == NULL) {
+    return IpcBufferReleaseResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, NOT_SUBSCRIBED_ERROR_MESSAGE, error);
+  }
+
+  error.offset = entry->offset;
+  const uint64_t acquired_head =
+      _is_single_consumer(buffer) ? entry->offset : LOCK(entry->offset);
+  if (_read_head(buffer) != acquired_head) {
+    return IpcBufferReleaseResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: entry is not acquired", error);
+  }
+
+  EntryInfo header;
+  const IpcStatus status =
+      _read_entry_header((struct IpcBuffer *)buffer, entry->offset, &header);
+  if (status != IPC_OK) {
+    return IpcBufferReleaseResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: acquired entry is unreadable",
+        error);
+  }
+
+  if (!_release_head(buffer, entry->offset, header.entry_size)) {
+    return IpcBufferReleaseResult_error_body(
         IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset", error);
   }
 
-  return IpcBufferPeekResult_ok(IPC_OK);
+  return IpcBufferReleaseResult_ok(IPC_OK);
 }
 
 IpcBufferSkipResult ipc_buffer_skip(IpcBuffer *buffer, const uint64_t offset) {
@@ -384,6 +1249,11 @@ IpcBufferSkipResult ipc_buffer_skip(IpcBuffer *buffer, const uint64_t offset) {
         "invalid argument: offset must be multiple of 8", error);
   }
 
+  if (buffer->head == NULL) {
+    return IpcBufferSkipResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, NOT_SUBSCRIBED_ERROR_MESSAGE, error);
+  }
+
   uint64_t head;
   do {
     head = _read_head(buffer);
@@ -400,14 +1270,14 @@ IpcBufferSkipResult ipc_buffer_skip(IpcBuffer *buffer, const uint64_t offset) {
           "Offset mismatch: expected different offset than current head",
           error);
     }
-  } while (!_lock(&((struct IpcBuffer *)buffer)->header->head, head));
+  } while (!_lock_head((struct IpcBuffer *)buffer, head));
 
-  EntryHeader header;
+  EntryInfo header;
   const IpcStatus status =
       _read_entry_header((struct IpcBuffer *)buffer, head, &header);
   const bool placeholder = status == IPC_PLACEHOLDER;
   if (!placeholder && status != IPC_OK) {
-    if (!_unlock(&((struct IpcBuffer *)buffer)->header->head, head)) {
+    if (!_unlock_head((struct IpcBuffer *)buffer, head)) {
       return IpcBufferSkipResult_error_body(
           IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset",
           error);
@@ -422,10 +1292,7 @@ IpcBufferSkipResult ipc_buffer_skip(IpcBuffer *buffer, const uint64_t offset) {
                                           error);
   }
 
-  uint64_t expected_current_head = LOCK(head);
-  if (!atomic_compare_exchange_strong(
-          &((struct IpcBuffer *)buffer)->header->head, &expected_current_head,
-          head + header.entry_size)) {
+  if (!_release_head(buffer, head, header.entry_size)) {
     return IpcBufferSkipResult_error_body(
         IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset", error);
   }
@@ -442,25 +1309,134 @@ IpcBufferSkipForceResult ipc_buffer_skip_force(IpcBuffer *buffer) {
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is NULL", error);
   }
 
+  if (buffer->head == NULL) {
+    return IpcBufferSkipForceResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, NOT_SUBSCRIBED_ERROR_MESSAGE, error);
+  }
+
   uint64_t head = UNLOCK(_read_head(buffer));
-  EntryHeader *header = NULL;
-  uint64_t entry_size;
-  IpcStatus status = _read_entry_header_unsafe(buffer, head, &header);
+  EntryInfo header;
+  IpcStatus status = _read_entry_header_unsafe(buffer, head);
 
   if (status == IPC_EMPTY) {
     return IpcBufferSkipForceResult_ok(IPC_EMPTY, head);
   }
 
-  entry_size = header->entry_size;
-  return atomic_compare_exchange_strong(
-             &((struct IpcBuffer *)buffer)->header->head, &head,
-             head + entry_size)
+  if (_is_concurrent_write(buffer)) {
+    // an unpublished entry has no trustworthy size, and the consumed region
+    // has to be poisoned before the head moves
+    if (!_lock_head((struct IpcBuffer *)buffer, head)) {
+      return IpcBufferSkipForceResult_ok(IPC_ALREADY_SKIPPED, head);
+    }
+
+    if (!_load_entry(buffer, head, &header)) {
+      if (!_unlock_head((struct IpcBuffer *)buffer, head)) {
+        return IpcBufferSkipForceResult_error_body(
+            IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset",
+            error);
+      }
+
+      return IpcBufferSkipForceResult_error_body(
+          IPC_ERR_NOT_READY, "entry is not published yet", error);
+    }
+
+    return _release_head(buffer, head, header.entry_size)
+               ? IpcBufferSkipForceResult_ok(IPC_OK, head)
+               : IpcBufferSkipForceResult_error_body(
+                     IPC_ERR_ILLEGAL_STATE,
+                     "illegal state: unexpected head offset", error);
+  }
+
+  // the stamp is not checked, forcing past a broken entry is the point
+  _load_entry(buffer, head, &header);
+  const uint64_t entry_size = header.entry_size;
+  if (_is_single_consumer(buffer)) {
+    _release_head(buffer, head, entry_size);
+    return IpcBufferSkipForceResult_ok(IPC_OK, head);
+  }
+
+  return atomic_compare_exchange_strong(buffer->head, &head,
+                                        head + entry_size)
              ? IpcBufferSkipForceResult_ok(IPC_OK, head)
              : IpcBufferSkipForceResult_ok(IPC_ALREADY_SKIPPED, head);
 }
 
 static inline uint64_t _read_head(const struct IpcBuffer *buffer) {
-  return atomic_load(&buffer->header->head);
+  return atomic_load(buffer->head);
+}
+
+// The writer may reuse everything below the slowest consumer. A broadcast
+// buffer without subscribers drops what it writes.
+static uint64_t _gate_head(const struct IpcBuffer *buffer,
+                           const uint64_t tail) {
+  if (!_is_broadcast(buffer)) {
+    return UNLOCK(atomic_load(&buffer->header->head));
+  }
+
+  uint64_t gate = tail;
+  for (uint32_t i = 0; i < buffer->subscribers; i++) {
+    const uint64_t head = atomic_load(&buffer->cursors[i].head);
+    if (head != CURSOR_FREE && UNLOCK(head) < gate) {
+      gate = UNLOCK(head);
+    }
+  }
+
+  return gate;
+}
+
+static inline bool _is_broadcast(const struct IpcBuffer *buffer) {
+  return (buffer->flags & IPC_BUFFER_BROADCAST) != 0;
+}
+
+// Points the handle at the regions of an initialized header.
+static void _bind_layout(struct IpcBuffer *buffer, void *mem) {
+  IpcBufferHeader *header = (IpcBufferHeader *)mem;
+  buffer->header = header;
+  buffer->data_size = atomic_load(&header->data_size);
+  buffer->flags = (uint32_t)header->flags;
+  buffer->subscribers = (uint32_t)header->subscribers;
+  buffer->entry_header_size = (buffer->flags & IPC_BUFFER_COMPACT_ENTRIES)
+                                  ? sizeof(CompactEntryHeader)
+                                  : sizeof(EntryHeader);
+  buffer->cursors =
+      (IpcCursor *)(((uint8_t *)mem) + BUFFER_HEADER_SIZE_ALIGNED);
+  buffer->data = (uint8_t *)(buffer->cursors + buffer->subscribers);
+  buffer->head = _is_broadcast(buffer) ? NULL : &header->head;
+  buffer->subscription = NULL;
+}
+
+// Takes a free slot and starts it at the current tail.
+static bool _claim_cursor(struct IpcBuffer *buffer, IpcCursor *cursor) {
+  uint64_t expected = CURSOR_FREE;
+  uint64_t tail = UNLOCK(atomic_load(&buffer->header->tail));
+  if (!atomic_compare_exchange_strong(&cursor->head, &expected, tail)) {
+    return false;
+  }
+
+  // writers that sized their space before the slot was claimed may have
+  // moved the tail on, follow it until the cursor is visible to them
+  for (uint64_t now = UNLOCK(atomic_load(&buffer->header->tail)); now != tail;
+       now = UNLOCK(atomic_load(&buffer->header->tail))) {
+    tail = now;
+    atomic_store(&cursor->head, tail);
+  }
+
+  buffer->head = &cursor->head;
+  buffer->subscription = cursor;
+  atomic_store_explicit(&buffer->cached_tail, tail, memory_order_release);
+  return true;
+}
+
+static void _lock_groups(struct IpcBuffer *buffer) {
+  uint32_t expected = 0;
+  while (!atomic_compare_exchange_weak(&buffer->header->groups_lock, &expected,
+                                       1)) {
+    expected = 0;
+  }
+}
+
+static void _unlock_groups(struct IpcBuffer *buffer) {
+  atomic_store(&buffer->header->groups_lock, 0);
 }
 
 static inline bool _is_aligned(const uint64_t offset) {
@@ -479,19 +1455,14 @@ static inline bool _unlock(_Atomic uint64_t *ref, const uint64_t offset) {
   return atomic_compare_exchange_strong(ref, &expected, UNLOCK(offset));
 }
 
-static IpcStatus _read_entry_header(const struct IpcBuffer *buffer,
-                                    const uint64_t offset, EntryHeader *dest) {
-  EntryHeader *header;
-  IpcStatus status = _read_entry_header_unsafe(buffer, offset, &header);
+static IpcStatus _read_entry_header(struct IpcBuffer *buffer,
+                                    const uint64_t offset, EntryInfo *dest) {
+  const IpcStatus status = _read_entry_header_unsafe(buffer, offset);
   if (status != IPC_OK) {
     return status;
   }
 
-  dest->seq = header->seq;
-  if (dest->seq == offset) {
-    dest->payload_size = header->payload_size;
-    dest->entry_size = header->entry_size;
-
+  if (_load_entry(buffer, offset, dest)) {
     if (dest->payload_size == 0) {
       return IPC_PLACEHOLDER;
     }
@@ -506,23 +1477,420 @@ static IpcStatus _read_entry_header(const struct IpcBuffer *buffer,
   return IPC_ERR_NOT_READY;
 }
 
-static IpcStatus _read_entry_header_unsafe(const struct IpcBuffer *buffer,
-                                           const uint64_t offset,
-                                           EntryHeader **dest) {
+static IpcStatus _read_entry_header_unsafe(struct IpcBuffer *buffer,
+                                           const uint64_t offset) {
   const uint64_t aligned_head = UNLOCK(offset);
-  const uint64_t tail = atomic_load(&buffer->header->tail);
-  if (aligned_head == UNLOCK(tail)) {
-    return IPC_EMPTY;
+  // everything below the committed tail is complete, so the shared tail is
+  // only consulted once the cached one is reached
+  uint64_t tail =
+      atomic_load_explicit(&buffer->cached_tail, memory_order_acquire);
+  if (aligned_head >= tail) {
+    tail = UNLOCK(atomic_load(&buffer->header->tail));
+    atomic_store_explicit(&buffer->cached_tail, tail, memory_order_release);
+    if (aligned_head == tail) {
+      return IPC_EMPTY;
+    }
+  }
+
+  return IPC_OK;
+}
+
+// Free space in front of tail against the cached head, reloading the shared
+// head only when the cache cannot satisfy required.
+static uint64_t _free_space(struct IpcBuffer *buffer, const uint64_t tail,
+                            const uint64_t required) {
+  uint64_t head =
+      atomic_load_explicit(&buffer->cached_head, memory_order_acquire);
+  // a head outside [tail - data_size, tail] was cached against another tail
+  // snapshot, the distance below would wrap around
+  if (head > tail || tail - head > buffer->data_size ||
+      buffer->data_size - (tail - head) < required) {
+    head = _gate_head(buffer, tail);
+    _cache_head(buffer, head);
+  }
+
+  return buffer->data_size - (tail - head);
+}
+
+// Moves cached_head forward only, a writer preempted after loading the head
+// must not put back a value older than what another writer cached meanwhile.
+static void _cache_head(struct IpcBuffer *buffer, const uint64_t head) {
+  uint64_t cached =
+      atomic_load_explicit(&buffer->cached_head, memory_order_relaxed);
+  while (cached < head &&
+         !atomic_compare_exchange_weak_explicit(&buffer->cached_head, &cached,
+                                                head, memory_order_release,
+                                                memory_order_relaxed)) {
   }
+}
+
+static inline bool _is_concurrent_write(const struct IpcBuffer *buffer) {
+  return (buffer->flags & IPC_BUFFER_CONCURRENT_WRITE) != 0;
+}
+
+static inline uint64_t _entry_size(const struct IpcBuffer *buffer,
+                                   const uint64_t payload_size) {
+  return ALIGN_UP(buffer->entry_header_size + payload_size, IPC_DATA_ALIGN);
+}
 
-  const uint64_t buf_size = atomic_load(&buffer->header->data_size);
-  const uint64_t rel_head = RELATIVE(aligned_head, buf_size);
+static inline uint8_t *_payload_at(const struct IpcBuffer *buffer,
+                                   const uint64_t offset) {
+  return buffer->data + RELATIVE(offset, buffer->data_size) +
+         buffer->entry_header_size;
+}
 
-  *dest = (EntryHeader *)(buffer->data + rel_head);
+static inline bool _is_compact(const struct IpcBuffer *buffer) {
+  return buffer->entry_header_size == sizeof(CompactEntryHeader);
+}
 
-  if (_is_locked(tail)) {
-    return IPC_ERR_NOT_READY;
+// Sizes first, then the stamp with release semantics: a reader that sees the
+// stamp sees the whole entry. A compact header is a single word, payload 0
+// marks a placeholder whose size lives in the length bits.
+static inline void _publish_entry(struct IpcBuffer *buffer,
+                                  const uint64_t offset,
+                                  const uint64_t payload_size,
+                                  const uint64_t entry_size) {
+  uint8_t *at = buffer->data + RELATIVE(offset, buffer->data_size);
+  if (_is_compact(buffer)) {
+    const uint32_t length = payload_size == 0
+                                ? COMPACT_PLACEHOLDER | (uint32_t)entry_size
+                                : (uint32_t)payload_size;
+    atomic_store_explicit(&((CompactEntryHeader *)at)->stamp,
+                          ((uint64_t)COMPACT_TAG(offset) << 32) | length,
+                          memory_order_release);
+    return;
   }
 
-  return IPC_OK;
+  EntryHeader *header = (EntryHeader *)at;
+  header->payload_size = payload_size;
+  header->entry_size = entry_size;
+  atomic_store_explicit(&header->seq, offset, memory_order_release);
+}
+
+// Decodes the header at offset, true if it is stamped for exactly this
+// offset, i.e. published.
+static bool _load_entry(const struct IpcBuffer *buffer, const uint64_t offset,
+                        EntryInfo *dest) {
+  const uint64_t aligned = UNLOCK(offset);
+  uint8_t *at = buffer->data + RELATIVE(aligned, buffer->data_size);
+  if (_is_compact(buffer)) {
+    const uint64_t stamp = atomic_load_explicit(
+        &((CompactEntryHeader *)at)->stamp, memory_order_acquire);
+    const uint32_t length = (uint32_t)stamp;
+    if ((length & COMPACT_PLACEHOLDER) != 0) {
+      dest->payload_size = 0;
+      dest->entry_size = length & ~COMPACT_PLACEHOLDER;
+    } else {
+      dest->payload_size = length;
+      dest->entry_size = _entry_size(buffer, length);
+    }
+
+    return stamp != COMPACT_POISON &&
+           (uint32_t)(stamp >> 32) == COMPACT_TAG(offset);
+  }
+
+  EntryHeader *header = (EntryHeader *)at;
+  const uint64_t seq = atomic_load_explicit(&header->seq, memory_order_acquire);
+  dest->payload_size = header->payload_size;
+  dest->entry_size = header->entry_size;
+
+  return seq == offset;
+}
+
+static inline bool _is_single_producer(const struct IpcBuffer *buffer) {
+  return (buffer->flags & IPC_BUFFER_SPSC) != 0;
+}
+
+// an overwriting writer moves the head as well, the consumer keeps the lock
+static inline bool _is_single_consumer(const struct IpcBuffer *buffer) {
+  return (buffer->flags & (IPC_BUFFER_SPSC | IPC_BUFFER_MPSC)) != 0 &&
+         !_is_overwrite(buffer);
+}
+
+// the sole consumer owns the head, there is nobody to lock it against
+static inline bool _lock_head(struct IpcBuffer *buffer, const uint64_t head) {
+  return _is_single_consumer(buffer) || _lock(buffer->head, head);
+}
+
+static inline bool _unlock_head(struct IpcBuffer *buffer, const uint64_t head) {
+  return _is_single_consumer(buffer) || _unlock(buffer->head, head);
+}
+
+// the sole producer owns the tail, a reservation is just a pending store
+static inline bool _lock_tail(struct IpcBuffer *buffer, const uint64_t tail) {
+  return _is_single_producer(buffer) || _lock(&buffer->header->tail, tail);
+}
+
+static inline bool _unlock_tail(struct IpcBuffer *buffer, const uint64_t tail) {
+  if (_is_single_producer(buffer)) {
+    return atomic_load_explicit(&buffer->header->tail, memory_order_relaxed) ==
+           tail;
+  }
+
+  return _unlock(&buffer->header->tail, tail);
+}
+
+static inline bool _advance_tail(struct IpcBuffer *buffer, const uint64_t tail,
+                                 const uint64_t new_tail) {
+  if (_is_single_producer(buffer)) {
+    atomic_store_explicit(&buffer->header->tail, new_tail,
+                          memory_order_release);
+    return true;
+  }
+
+  uint64_t expected_tail = LOCK(tail);
+  return atomic_compare_exchange_strong(&buffer->header->tail, &expected_tail,
+                                        new_tail);
+}
+
+static bool _release_head(struct IpcBuffer *buffer, const uint64_t head,
+                          const uint64_t entry_size) {
+  if (_is_concurrent_write(buffer)) {
+    // a batch of entries may span the wrap point
+    const uint64_t buf_size = buffer->data_size;
+    const uint64_t rel_head = RELATIVE(head, buf_size);
+    const uint64_t first_part = buf_size - rel_head < entry_size
+                                    ? buf_size - rel_head
+                                    : entry_size;
+    memset(buffer->data + rel_head, POISON_BYTE, first_part);
+    memset(buffer->data, POISON_BYTE, entry_size - first_part);
+  }
+
+  if (_is_single_consumer(buffer)) {
+    atomic_store_explicit(buffer->head, head + entry_size,
+                          memory_order_release);
+    return true;
+  }
+
+  uint64_t expected_current_head = LOCK(head);
+  return atomic_compare_exchange_strong(buffer->head, &expected_current_head,
+                                        head + entry_size);
+}
+
+// a mirrored region continues past the wrap point, an entry is contiguous
+// wherever it starts
+static inline bool _needs_placeholder(const struct IpcBuffer *buffer,
+                                      const uint64_t space_to_wrap,
+                                      const uint64_t entry_size) {
+  return (buffer->flags & IPC_BUFFER_MIRRORED) == 0 &&
+         space_to_wrap < entry_size + buffer->entry_header_size;
+}
+
+// Lays out the longest prefix of messages that fits into the free space
+// starting at tail, with at most one placeholder where the batch wraps. The
+// cached head is tried first and reloaded only if the batch is cut short. An
+// overwrite ring may evict everything, so its limit is the whole ring; if
+// even the first entry does not fit, only its placeholder is planned.
+static size_t _plan_batch(struct IpcBuffer *buffer, const uint64_t tail,
+                          const IpcMessage *messages, const size_t count,
+                          uint64_t *batch_size) {
+  const uint64_t buf_size = buffer->data_size;
+  const bool overwrite = _is_overwrite(buffer);
+
+  size_t i = 0;
+  uint64_t offset = tail;
+  for (uint64_t required = overwrite ? buf_size : 0;; required = buf_size) {
+    const uint64_t limit =
+        tail + (overwrite ? buf_size : _free_space(buffer, tail, required));
+
+    offset = tail;
+    for (i = 0; i < count; i++) {
+      const uint64_t entry_size = _entry_size(buffer, messages[i].size);
+      const uint64_t rel_offset = RELATIVE(offset, buf_size);
+      const uint64_t space_to_wrap = buf_size - rel_offset;
+
+      uint64_t next = offset + entry_size;
+      if (rel_offset != 0 &&
+          _needs_placeholder(buffer, space_to_wrap, entry_size)) {
+        next += space_to_wrap;
+      }
+
+      if (next > limit) {
+        break;
+      }
+
+      offset = next;
+    }
+
+    if (i == count || required == buf_size) {
+      break;
+    }
+  }
+
+  if (i == 0 && overwrite) {
+    *batch_size = buf_size - RELATIVE(tail, buf_size);
+    return 0;
+  }
+
+  *batch_size = offset - tail;
+  return i;
+}
+
+static inline bool _is_overwrite(const struct IpcBuffer *buffer) {
+  return (buffer->flags & IPC_BUFFER_OVERWRITE) != 0;
+}
+
+// Moves the shared head past the oldest entries until required bytes are
+// free in front of tail. Runs with the tail claimed, so the entries it walks
+// are stable; a reader holding one of them loses its lock with it and finds
+// out on release.
+static void _evict(struct IpcBuffer *buffer, const uint64_t tail,
+                   const uint64_t required) {
+  _Atomic uint64_t *ref = &buffer->header->head;
+  uint64_t head = atomic_load(ref);
+  while (buffer->data_size - (tail - UNLOCK(head)) < required) {
+    EntryInfo info;
+    _load_entry(buffer, UNLOCK(head), &info);
+    const uint64_t next = UNLOCK(head) + info.entry_size;
+    if (!atomic_compare_exchange_strong(ref, &head, next)) {
+      continue;
+    }
+
+    if (info.payload_size != 0) {
+      atomic_fetch_add(&buffer->header->overwritten, 1);
+    }
+    head = next;
+  }
+
+  _cache_head(buffer, UNLOCK(head));
+}
+
+// Seqlock style check after reading an entry under the head lock: the writer
+// moves the head before it touches the bytes, so an unchanged head means
+// everything read so far was intact.
+static inline bool _overrun(const struct IpcBuffer *buffer,
+                            const uint64_t head) {
+  atomic_thread_fence(memory_order_acquire);
+  return atomic_load_explicit(buffer->head, memory_order_relaxed) !=
+         LOCK(head);
+}
+
+static uint64_t _take_overwritten(struct IpcBuffer *buffer) {
+  if (!_is_overwrite(buffer)) {
+    return 0;
+  }
+
+  const uint64_t overwritten = atomic_load(&buffer->header->overwritten);
+  const uint64_t lost = overwritten - buffer->overwritten_seen;
+  buffer->overwritten_seen = overwritten;
+  return lost;
+}
+
+// The head is claimed once: the entry is checked, the destination sized by
+// sizer when there is one, the payload copied and the head released.
+static IpcBufferReadResult _read(IpcBuffer *buffer, IpcEntry *dest,
+                                 IpcPayloadSizer sizer, void *ctx) {
+  IpcBufferReadError error = {.offset = 0};
+
+  if (buffer == NULL) {
+    return IpcBufferReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: buffer is NULL", error);
+  }
+
+  if (dest == NULL) {
+    return IpcBufferReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: dest is NULL", error);
+  }
+
+  if (buffer->head == NULL) {
+    return IpcBufferReadResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, NOT_SUBSCRIBED_ERROR_MESSAGE, error);
+  }
+
+  // an overwrite ring starts over from the new head whenever the writer laps
+  // the entry, dest is only written once the entry is released intact
+  const bool overwrite = _is_overwrite(buffer);
+  for (;;) {
+    uint64_t head;
+    do {
+      head = _read_head(buffer);
+      if (_is_locked(head)) {
+        error.offset = UNLOCK(head);
+        return IpcBufferReadResult_error_body(IPC_ERR_LOCKED,
+                                              "entry is locked", error);
+      }
+
+    } while (!_lock_head((struct IpcBuffer *)buffer, head));
+
+    EntryInfo header;
+
+    const IpcStatus status =
+        _read_entry_header((struct IpcBuffer *)buffer, head, &header);
+    if (overwrite && _overrun(buffer, head)) {
+      // lapped while the header was loaded, its seq or sizes may be stale
+      continue;
+    }
+
+    const bool placeholder = status == IPC_PLACEHOLDER;
+    if (!placeholder && status != IPC_OK) {
+      if (!_unlock_head((struct IpcBuffer *)buffer, head)) {
+        if (overwrite) {
+          continue;
+        }
+
+        return IpcBufferReadResult_error_body(
+            IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset",
+            error);
+      }
+
+      if (status == IPC_EMPTY) {
+        return IpcBufferReadResult_ok(IPC_EMPTY);
+      }
+
+      error.offset = head;
+      return IpcBufferReadResult_error_body(status, "unreadable entry state",
+                                            error);
+    }
+
+    void *payload = dest->payload;
+    if (!placeholder) {
+      // sized while the head is held, the entry can not change in between
+      bool fits = dest->size >= header.payload_size;
+      if (sizer != NULL) {
+        payload = sizer(header.payload_size, ctx);
+        fits = payload != NULL;
+      }
+
+      if (!fits) {
+        error.offset = head;
+        error.required_size = header.payload_size;
+        if (!_unlock_head((struct IpcBuffer *)buffer, head)) {
+          if (overwrite) {
+            continue;
+          }
+
+          return IpcBufferReadResult_error_body(
+              IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset",
+              error);
+        }
+
+        return sizer != NULL
+                   ? IpcBufferReadResult_error_body(
+                         IPC_ERR_SYSTEM, "system error: sizer failed", error)
+                   : IpcBufferReadResult_error_body(
+                         IPC_ERR_TOO_SMALL, "destination buffer is too small",
+                         error);
+      }
+
+      memcpy(payload, _payload_at(buffer, head), header.payload_size);
+    }
+
+    if (!_release_head(buffer, head, header.entry_size)) {
+      // the writer took the entry back, the copy may be torn
+      if (overwrite) {
+        continue;
+      }
+
+      return IpcBufferReadResult_error_body(
+          IPC_ERR_ILLEGAL_STATE, "illegal state: unexpected head offset",
+          error);
+    }
+
+    if (!placeholder) {
+      dest->payload = payload;
+      dest->offset = head;
+      dest->size = header.payload_size;
+      return IpcBufferReadResult_ok(IPC_OK);
+    }
+  }
 }
@@ -1,6 +1,9 @@
+#include "ipc_eventfd.h"
 #include "ipc_futex.h"
+#include "ipc_payload_pool.h"
 #include "ipc_utils.h"
 #include <errno.h>
+#include <sched.h>
 #include <shmipc/ipc_buffer.h>
 #include <shmipc/ipc_channel.h>
 #include <shmipc/ipc_common.h>
@@ -8,25 +11,110 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
 
 #define WAIT_EXPAND_FACTOR 2
+#define DEADLINE_CHECK_ROUNDS 64
 #define NANOS_PER_SEC 1000000000ULL
+// naps of ipc_channel_select without futex_waitv
+#define SELECT_MIN_NAP_NS 1000ULL
+#define SELECT_MAX_NAP_NS 1000000ULL
 
 #define CHANNEL_HEADER_SIZE_ALIGNED                                            \
   ALIGN_UP_BY_CACHE_LINE(sizeof(IpcChannelHeader))
 
 typedef struct IpcChannelHeader {
   _Atomic uint32_t notify;
+  // consumers about to sleep on notify, each woken one takes an entry
+  _Atomic uint32_t notify_waiters;
+  // ipc_channel_select callers about to sleep on notify; they take nothing,
+  // so while there are any a wakeup goes to everybody. Producers skip it
+  // while both counts are 0 and the readiness descriptor is not armed.
+  _Atomic uint32_t notify_watchers;
+  // bumped by consumers when they free space, but only while space_waiters
+  // says a producer is parked in ipc_channel_write_timed
+  _Atomic uint32_t space;
+  _Atomic uint32_t space_waiters;
+  // readiness descriptor, see ipc_channel_get_readiness_fd. ready_gen moves
+  // whenever the owner changes.
+  _Atomic uint32_t ready_armed;
+  _Atomic uint32_t ready_owned;
+  _Atomic uint32_t ready_gen;
+  _Atomic int32_t ready_pid;
+  _Atomic int32_t ready_fd;
+  // generation (high half) and errno (low half) of the last producer that
+  // could not reach the descriptor, reported to its owner
+  _Atomic uint64_t ready_fault;
 } IpcChannelHeader;
 
 struct IpcChannel {
   IpcChannelHeader *header;
   IpcBuffer *buffer;
+  // local to this handle, see ipc_channel_set_wait_strategy
+  IpcWaitStrategy wait;
+  // every subscriber needs every wakeup, see _notify
+  bool broadcast;
+  // the readiness descriptor when this handle owns it, -1 otherwise
+  int ready_fd;
+  // this process' copy of the owner's descriptor for ready_copy_gen, -1 when
+  // it could not be taken, guarded by ready_lock
+  int ready_copy;
+  uint32_t ready_copy_gen;
+  _Atomic bool ready_lock;
+  // recycles read payloads, NULL until ipc_channel_enable_payload_pool
+  IpcPayloadPool *pool;
 };
 
+// Per blocking call: the waits so far, and whether the call is counted in
+// waiters (NULL when the caller announces itself).
+typedef struct WaitState {
+  _Atomic uint32_t *waiters;
+  uint32_t rounds;
+  bool parked;
+  bool expired;
+} WaitState;
+
+// Destination of _try_read, sized by _size_payload once the entry is claimed.
+typedef struct PayloadSizing {
+  IpcChannel *channel;
+  void *payload;
+  size_t capacity;
+} PayloadSizing;
+
 static IpcChannelReadResult _try_read(IpcChannel *, IpcEntry *);
+static IpcChannelConnectResult _connect(void *, const IpcBufferOptions *);
 static bool _is_error_status(const IpcStatus);
 static bool _is_retry_status(const IpcStatus);
+static IpcStatus _wait(IpcChannel *, _Atomic uint32_t *, const uint32_t,
+                       const uint64_t, WaitState *, int *);
+static void _wait_end(IpcChannel *, WaitState *, const bool);
+static void _notify(IpcChannel *, const size_t);
+static void _wake(IpcChannel *, const uint32_t, const uint32_t, const size_t);
+static void _pass_on(IpcChannel *);
+static bool _disarm(IpcChannel *);
+static void _signal_ready(IpcChannel *);
+static int _ready_fault(const IpcChannel *);
+static void _release_ready(IpcChannel *);
+static void _init_handle(IpcChannel *, IpcChannelHeader *, IpcBuffer *);
+static void _consumed(IpcChannel *);
+static void _signal_space(IpcChannel *);
+static bool _deadline_after(const struct timespec *, uint64_t *);
+static void *_alloc_payload(IpcChannel *, const size_t, size_t *);
+static void _free_payload(IpcChannel *, void *);
+static void *_size_payload(size_t, void *);
+static IpcChannelWriteResult _write_until(IpcChannel *, const void *,
+                                          const size_t, const uint64_t);
+static IpcChannelReadResult _read_until(IpcChannel *, IpcEntry *,
+                                        const uint64_t, IpcChannelReadError);
+static IpcChannelDrainResult _drain_until(IpcChannel *, IpcEntryCallback,
+                                          void *, const size_t, const uint64_t,
+                                          IpcChannelDrainError);
+static IpcChannelAcquireResult _acquire_until(IpcChannel *, IpcEntry *,
+                                              const uint64_t,
+                                              IpcChannelAcquireError);
+static IpcChannelSelectResult _select_until(IpcChannel *const *,
+                                            const size_t, const uint64_t,
+                                            uint64_t *, IpcChannelSelectError);
 
 inline uint64_t ipc_channel_get_memory_overhead(void) {
   return CHANNEL_HEADER_SIZE_ALIGNED + ipc_buffer_get_memory_overhead();
@@ -47,7 +135,20 @@ uint64_t ipc_channel_suggest_size(size_t desired_capacity) {
   return find_next_power_of_2(desired_capacity) + overhead;
 }
 
+uint64_t ipc_channel_suggest_size_with_options(size_t desired_capacity,
+                                               const IpcBufferOptions *options) {
+  return CHANNEL_HEADER_SIZE_ALIGNED +
+         ipc_buffer_suggest_size_with_options(desired_capacity, options);
+}
+
 IpcChannelOpenResult ipc_channel_create(void *mem, const size_t size) {
+  const IpcBufferOptions options = {.flags = 0};
+  return ipc_channel_create_with_options(mem, size, &options);
+}
+
+IpcChannelOpenResult
+ipc_channel_create_with_options(void *mem, const size_t size,
+                                const IpcBufferOptions *options) {
   const size_t min_total = ipc_channel_get_memory_overhead();
   IpcChannelOpenError error = {
       .requested_size = size, .min_size = min_total, .sys_errno = 0};
@@ -63,8 +164,9 @@ IpcChannelOpenResult ipc_channel_create(void *mem, const size_t size) {
   }
 
   uint8_t *buffer_memory = ((uint8_t *)mem) + CHANNEL_HEADER_SIZE_ALIGNED;
-  const IpcBufferCreateResult buffer_result = ipc_buffer_create(
-      (void *)buffer_memory, (size_t)size - CHANNEL_HEADER_SIZE_ALIGNED);
+  const IpcBufferCreateResult buffer_result = ipc_buffer_create_with_options(
+      (void *)buffer_memory, (size_t)size - CHANNEL_HEADER_SIZE_ALIGNED,
+      options);
   if (IpcBufferCreateResult_is_error(buffer_result)) {
     error.requested_size = size;
     error.sys_errno = buffer_result.error.body.sys_errno;
@@ -81,43 +183,269 @@ IpcChannelOpenResult ipc_channel_create(void *mem, const size_t size) {
         IPC_ERR_SYSTEM, "system error: channel allocation failed", error);
   }
 
-  channel->header = (IpcChannelHeader *)mem;
-  channel->buffer = buffer_result.result;
+  _init_handle(channel, (IpcChannelHeader *)mem, buffer_result.result);
 
   atomic_init(&channel->header->notify, 0);
+  atomic_init(&channel->header->notify_waiters, 0);
+  atomic_init(&channel->header->notify_watchers, 0);
+  atomic_init(&channel->header->space, 0);
+  atomic_init(&channel->header->space_waiters, 0);
+  atomic_init(&channel->header->ready_armed, 0);
+  atomic_init(&channel->header->ready_owned, 0);
+  atomic_init(&channel->header->ready_gen, 0);
+  atomic_init(&channel->header->ready_pid, 0);
+  atomic_init(&channel->header->ready_fd, -1);
+  atomic_init(&channel->header->ready_fault, 0);
 
   return IpcChannelOpenResult_ok(IPC_OK, channel);
 }
 
 IpcChannelConnectResult ipc_channel_connect(void *mem) {
-  const size_t min_total = ipc_channel_get_memory_overhead();
-  IpcChannelConnectError error = {.min_size = min_total};
+  return _connect(mem, NULL);
+}
 
-  if (mem == NULL) {
+IpcChannelConnectResult
+ipc_channel_connect_with_options(void *mem, const IpcBufferOptions *options) {
+  if (options == NULL) {
+    const IpcChannelConnectError error = {
+        .min_size = ipc_channel_get_memory_overhead()};
     return IpcChannelConnectResult_error_body(
-        IPC_ERR_INVALID_ARGUMENT, "invalid argument: mem is NULL", error);
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: options is NULL", error);
   }
 
-  IpcChannel *channel = (IpcChannel *)malloc(sizeof(IpcChannel));
+  return _connect(mem, options);
+}
+
+uint32_t ipc_channel_get_flags(const IpcChannel *channel) {
+  return channel == NULL ? 0 : ipc_buffer_get_flags(channel->buffer);
+}
+
+IpcChannelSubscribeResult ipc_channel_subscribe(IpcChannel *channel) {
+  IpcChannelSubscribeError error = {.subscribers = 0};
+  if (channel == NULL) {
+    return IpcChannelSubscribeResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  const IpcBufferSubscribeResult result =
+      ipc_buffer_subscribe(channel->buffer);
+  if (IpcBufferSubscribeResult_is_error(result)) {
+    if (IpcBufferSubscribeResult_is_error_has_body(result.error)) {
+      error.subscribers = result.error.body.subscribers;
+    }
+
+    return IpcChannelSubscribeResult_error_body(result.ipc_status,
+                                                result.error.detail, error);
+  }
+
+  return IpcChannelSubscribeResult_ok(IPC_OK, result.result);
+}
+
+IpcChannelJoinGroupResult ipc_channel_join_group(IpcChannel *channel,
+                                                 const char *name) {
+  IpcChannelJoinGroupError error = {.subscribers = 0};
+  if (channel == NULL) {
+    return IpcChannelJoinGroupResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  const IpcBufferJoinGroupResult result =
+      ipc_buffer_join_group(channel->buffer, name);
+  if (IpcBufferJoinGroupResult_is_error(result)) {
+    if (IpcBufferJoinGroupResult_is_error_has_body(result.error)) {
+      error.subscribers = result.error.body.subscribers;
+    }
+
+    return IpcChannelJoinGroupResult_error_body(result.ipc_status,
+                                                result.error.detail, error);
+  }
+
+  return IpcChannelJoinGroupResult_ok(IPC_OK, result.result);
+}
+
+IpcChannelUnsubscribeResult ipc_channel_unsubscribe(IpcChannel *channel) {
+  if (channel == NULL) {
+    return IpcChannelUnsubscribeResult_error(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL");
+  }
+
+  const IpcBufferUnsubscribeResult result =
+      ipc_buffer_unsubscribe(channel->buffer);
+  if (IpcBufferUnsubscribeResult_is_error(result)) {
+    return IpcChannelUnsubscribeResult_error(result.ipc_status,
+                                             result.error.detail);
+  }
+
+  // the writer may have been gated by the departed cursor
+  _signal_space(channel);
+  return IpcChannelUnsubscribeResult_ok(IPC_OK);
+}
+
+IpcChannelSetWaitStrategyResult
+ipc_channel_set_wait_strategy(IpcChannel *channel,
+                              const IpcWaitStrategy *strategy) {
+  if (channel == NULL) {
+    return IpcChannelSetWaitStrategyResult_error(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL");
+  }
+
+  if (strategy == NULL) {
+    return IpcChannelSetWaitStrategyResult_error(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: strategy is NULL");
+  }
+
+  if (strategy->kind != IPC_WAIT_FUTEX &&
+      strategy->kind != IPC_WAIT_BUSY_SPIN &&
+      strategy->kind != IPC_WAIT_SPIN_YIELD &&
+      strategy->kind != IPC_WAIT_SPIN_FUTEX) {
+    return IpcChannelSetWaitStrategyResult_error(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: unknown wait strategy");
+  }
+
+  channel->wait = *strategy;
+  return IpcChannelSetWaitStrategyResult_ok(IPC_OK);
+}
+
+IpcChannelEnablePayloadPoolResult
+ipc_channel_enable_payload_pool(IpcChannel *channel, const size_t max_cached) {
+  IpcChannelEnablePayloadPoolError error = {.sys_errno = 0};
   if (channel == NULL) {
+    return IpcChannelEnablePayloadPoolResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (max_cached == 0) {
+    return IpcChannelEnablePayloadPoolResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: max_cached is 0", error);
+  }
+
+  if (channel->pool != NULL) {
+    return IpcChannelEnablePayloadPoolResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: payload pool already enabled",
+        error);
+  }
+
+  channel->pool = ipc_payload_pool_create(max_cached);
+  if (channel->pool == NULL) {
     error.sys_errno = errno;
-    return IpcChannelConnectResult_error_body(
-        IPC_ERR_SYSTEM, "system error: channel allocation failed", error);
+    return IpcChannelEnablePayloadPoolResult_error_body(
+        IPC_ERR_SYSTEM, "system error: pool allocation failed", error);
   }
 
-  uint8_t *buffer_memory = ((uint8_t *)mem) + CHANNEL_HEADER_SIZE_ALIGNED;
-  const IpcBufferAttachResult buffer_result =
-      ipc_buffer_attach((void *)buffer_memory);
-  if (IpcBufferAttachResult_is_error(buffer_result)) {
-    free(channel);
-    return IpcChannelConnectResult_error_body(
-        buffer_result.ipc_status, buffer_result.error.detail, error);
+  return IpcChannelEnablePayloadPoolResult_ok(IPC_OK);
+}
+
+IpcPayloadPoolStats ipc_channel_get_payload_pool_stats(
+    const IpcChannel *channel) {
+  IpcPayloadPoolStats stats = {.hits = 0, .misses = 0};
+  if (channel != NULL && channel->pool != NULL) {
+    ipc_payload_pool_stats(channel->pool, &stats.hits, &stats.misses);
   }
 
-  channel->header = (IpcChannelHeader *)mem;
-  channel->buffer = buffer_result.result;
+  return stats;
+}
 
-  return IpcChannelConnectResult_ok(IPC_OK, channel);
+void ipc_entry_release(IpcEntry *entry) {
+  if (entry == NULL) {
+    return;
+  }
+
+  ipc_payload_pool_release(entry->payload);
+  entry->payload = NULL;
+  entry->size = 0;
+}
+
+IpcChannelReadinessFdResult ipc_channel_get_readiness_fd(IpcChannel *channel) {
+  IpcChannelReadinessFdError error = {.sys_errno = 0};
+  if (channel == NULL) {
+    return IpcChannelReadinessFdResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->ready_fd >= 0) {
+    const int fault = _ready_fault(channel);
+    if (fault != 0) {
+      error.sys_errno = fault;
+      return IpcChannelReadinessFdResult_error_body(
+          IPC_ERR_SYSTEM, "system error: readiness fd unreachable by a producer",
+          error);
+    }
+
+    return IpcChannelReadinessFdResult_ok(IPC_OK, channel->ready_fd);
+  }
+
+  const int fd = ipc_eventfd_open();
+  if (fd < 0) {
+    error.sys_errno = errno;
+    return IpcChannelReadinessFdResult_error_body(
+        IPC_ERR_SYSTEM, "system error: eventfd failed", error);
+  }
+
+  uint32_t owned = 0;
+  if (!atomic_compare_exchange_strong(&channel->header->ready_owned, &owned,
+                                      1)) {
+    close(fd);
+    return IpcChannelReadinessFdResult_error_body(
+        IPC_ERR_ILLEGAL_STATE,
+        "illegal state: readiness fd is owned by another handle", error);
+  }
+
+  atomic_store(&channel->header->ready_pid, (int32_t)getpid());
+  atomic_store(&channel->header->ready_fd, fd);
+  atomic_fetch_add_explicit(&channel->header->ready_gen, 1,
+                            memory_order_release);
+  channel->ready_fd = fd;
+
+  return IpcChannelReadinessFdResult_ok(IPC_OK, fd);
+}
+
+IpcChannelArmReadinessResult ipc_channel_arm_readiness(IpcChannel *channel) {
+  IpcChannelArmReadinessError error = {.sys_errno = 0};
+  if (channel == NULL) {
+    return IpcChannelArmReadinessResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->ready_fd < 0) {
+    return IpcChannelArmReadinessResult_error_body(
+        IPC_ERR_ILLEGAL_STATE,
+        "illegal state: handle does not own the readiness fd", error);
+  }
+
+  const int fault = _ready_fault(channel);
+  if (fault != 0) {
+    error.sys_errno = fault;
+    return IpcChannelArmReadinessResult_error_body(
+        IPC_ERR_SYSTEM, "system error: readiness fd unreachable by a producer",
+        error);
+  }
+
+  if (ipc_eventfd_clear(channel->ready_fd) != 0) {
+    error.sys_errno = errno;
+    return IpcChannelArmReadinessResult_error_body(
+        IPC_ERR_SYSTEM, "system error: eventfd read failed", error);
+  }
+
+  atomic_store(&channel->header->ready_armed, 1);
+  // pairs with the fence in _notify, like the one in _wait
+  atomic_thread_fence(memory_order_seq_cst);
+
+  // a locked or unfinished head is handed on by its consumer or producer
+  IpcEntry entry;
+  const IpcBufferPeekResult peek_result =
+      ipc_buffer_peek(channel->buffer, &entry);
+  if (_is_retry_status(peek_result.ipc_status)) {
+    return IpcChannelArmReadinessResult_ok(IPC_OK, false);
+  }
+
+  // taken back, unless a producer fired it already
+  _disarm(channel);
+  if (IpcBufferPeekResult_is_error(peek_result)) {
+    return IpcChannelArmReadinessResult_error_body(
+        peek_result.ipc_status, peek_result.error.detail, error);
+  }
+
+  return IpcChannelArmReadinessResult_ok(IPC_OK, true);
 }
 
 IpcChannelDestroyResult ipc_channel_destroy(IpcChannel *channel) {
@@ -133,6 +461,13 @@ IpcChannelDestroyResult ipc_channel_destroy(IpcChannel *channel) {
         IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
   }
 
+  // a claimed subscriber slot would gate the writer forever
+  if (IpcBufferUnsubscribeResult_is_ok(
+          ipc_buffer_unsubscribe(channel->buffer))) {
+    _signal_space(channel);
+  }
+  _release_ready(channel);
+  ipc_payload_pool_destroy(channel->pool);
   free(channel->buffer);
   free(channel);
   return IpcChannelDestroyResult_ok(IPC_OK);
@@ -159,8 +494,7 @@ IpcChannelWriteResult ipc_channel_write(IpcChannel *channel, const void *data,
       ipc_buffer_write(channel->buffer, data, size);
   if (IpcBufferWriteResult_is_error(write_result)) {
     if (write_result.ipc_status == IPC_ERR_NO_SPACE_CONTIGUOUS) {
-      atomic_fetch_add(&channel->header->notify, 1);
-      ipc_futex_wake_all(&channel->header->notify);
+      _notify(channel, 1);
     }
 
     if (IpcBufferWriteResult_is_error_has_body(write_result.error)) {
@@ -175,216 +509,824 @@ IpcChannelWriteResult ipc_channel_write(IpcChannel *channel, const void *data,
                                             write_result.error.detail, error);
   }
 
-  atomic_fetch_add(&channel->header->notify, 1);
-  ipc_futex_wake_all(&channel->header->notify);
+  _notify(channel, 1);
 
   return IpcChannelWriteResult_ok(write_result.ipc_status);
 }
 
-IpcChannelTryReadResult ipc_channel_try_read(IpcChannel *channel,
-                                             IpcEntry *dest) {
-  IpcChannelTryReadError error = {.offset = 0};
+IpcChannelWriteResult ipc_channel_write_timed(IpcChannel *channel,
+                                              const void *data,
+                                              const size_t size,
+                                              const struct timespec *timeout) {
+  IpcChannelWriteError error = {.offset = 0,
+                                .requested_size = (size_t)size,
+                                .available_contiguous = 0,
+                                .buffer_size = 0};
 
   if (channel == NULL) {
-    return IpcChannelTryReadResult_error_body(
+    return IpcChannelWriteResult_error_body(
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
   }
 
-  if (channel->buffer == NULL) {
-    return IpcChannelTryReadResult_error_body(
-        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
-  }
-
-  if (dest == NULL) {
-    return IpcChannelTryReadResult_error_body(
-        IPC_ERR_INVALID_ARGUMENT, "invalid argument: dest is NULL", error);
+  if (timeout == NULL) {
+    return IpcChannelWriteResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: timeout is NULL", error);
   }
 
-  IpcEntry read_entry = {.offset = 0, .payload = NULL, .size = 0};
-  const IpcChannelReadResult read_result = _try_read(channel, &read_entry);
-  if (read_result.ipc_status == IPC_OK) {
-    dest->payload = read_entry.payload;
-    dest->size = read_entry.size;
-    dest->offset = read_entry.offset;
-  } else {
-    free(read_entry.payload);
+  if (timeout->tv_nsec < 0 || timeout->tv_sec < 0) {
+    return IpcChannelWriteResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: timeout must be {timeout->tv_nsec >= 0 && "
+        "timeout->tv_sec >= 0}",
+        error);
   }
 
-  if (IpcChannelReadResult_is_error(read_result)) {
-    error.offset = read_result.error.body.offset;
-    return IpcChannelTryReadResult_error_body(read_result.ipc_status,
-                                              read_result.error.detail, error);
+  uint64_t deadline_ns;
+  if (!_deadline_after(timeout, &deadline_ns)) {
+    return IpcChannelWriteResult_error_body(
+        IPC_ERR_SYSTEM, "system error: clock_gettime failed", error);
   }
 
-  return IpcChannelTryReadResult_ok(read_result.ipc_status);
+  return _write_until(channel, data, size, deadline_ns);
 }
 
-IpcChannelReadResult ipc_channel_read(IpcChannel *channel, IpcEntry *dest,
-                                      const struct timespec *timeout) {
-  IpcChannelReadError error = {.offset = 0, .timeout_used = {0, 0}};
+IpcChannelWriteResult ipc_channel_write_until(IpcChannel *channel,
+                                              const void *data,
+                                              const size_t size,
+                                              const struct timespec *deadline) {
+  IpcChannelWriteError error = {.offset = 0,
+                                .requested_size = (size_t)size,
+                                .available_contiguous = 0,
+                                .buffer_size = 0};
 
   if (channel == NULL) {
-    return IpcChannelReadResult_error_body(
+    return IpcChannelWriteResult_error_body(
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
   }
 
-  if (channel->buffer == NULL) {
-    return IpcChannelReadResult_error_body(
-        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
-  }
-
-  if (dest == NULL) {
-    return IpcChannelReadResult_error_body(
-        IPC_ERR_INVALID_ARGUMENT, "invalid argument: dest is NULL", error);
-  }
-
-  if (timeout == NULL) {
-    return IpcChannelReadResult_error_body(
-        IPC_ERR_INVALID_ARGUMENT, "invalid argument: timeout is NULL", error);
+  if (deadline == NULL) {
+    return IpcChannelWriteResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: deadline is NULL", error);
   }
 
-  if (timeout->tv_nsec < 0 || timeout->tv_sec < 0) {
-    return IpcChannelReadResult_error_body(
+  if (deadline->tv_nsec < 0 || deadline->tv_sec < 0) {
+    return IpcChannelWriteResult_error_body(
         IPC_ERR_INVALID_ARGUMENT,
-        "invalid argument: timeout must be {timeout->tv_nsec >= 0 && "
-        "timeout->tv_sec >= 0}",
+        "invalid argument: deadline must be {deadline->tv_nsec >= 0 && "
+        "deadline->tv_sec >= 0}",
         error);
   }
 
-  error.timeout_used = *timeout;
+  return _write_until(channel, data, size, ipc_timespec_to_nanos(deadline));
+}
 
-  uint64_t start_ns = 0;
-  uint64_t timeout_ns = 0;
-  struct timespec start_time;
-  if (clock_gettime(CLOCK_MONOTONIC, &start_time) != 0) {
-    error.sys_errno = errno;
-    return IpcChannelReadResult_error_body(
-        IPC_ERR_SYSTEM, "system error: clock_gettime failed", error);
+IpcChannelWritevResult ipc_channel_writev(IpcChannel *channel,
+                                          const struct iovec *iov,
+                                          const int iovcnt) {
+  IpcChannelWritevError error = {.offset = 0,
+                                 .requested_size = 0,
+                                 .available_contiguous = 0,
+                                 .buffer_size = 0};
+
+  if (channel == NULL) {
+    return IpcChannelWritevResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
   }
-  start_ns = ipc_timespec_to_nanos(&start_time);
-  timeout_ns = ipc_timespec_to_nanos(timeout);
 
-  IpcEntry read_entry = {.offset = 0, .payload = NULL, .size = 0};
-  for (;;) {
-    IpcEntry peek_entry;
-    const IpcBufferPeekResult peek_result =
-        ipc_buffer_peek(channel->buffer, &peek_entry);
-
-    if (peek_result.ipc_status == IPC_OK) {
-      const IpcChannelReadResult read_result = _try_read(channel, &read_entry);
-      if (_is_error_status(read_result.ipc_status)) {
-        free(read_entry.payload);
-        return read_result;
-      }
+  if (channel->buffer == NULL) {
+    return IpcChannelWritevResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
 
-      if (read_result.ipc_status == IPC_OK) {
-        dest->payload = read_entry.payload;
-        dest->size = read_entry.size;
-        dest->offset = read_entry.offset;
-        return read_result;
-      }
+  const IpcBufferWritevResult write_result =
+      ipc_buffer_writev(channel->buffer, iov, iovcnt);
+  if (IpcBufferWritevResult_is_error(write_result)) {
+    if (write_result.ipc_status == IPC_ERR_NO_SPACE_CONTIGUOUS) {
+      _notify(channel, 1);
     }
 
-    if (!_is_retry_status(peek_result.ipc_status)) {
-      free(read_entry.payload);
-      error.offset = peek_entry.offset;
-      return IpcChannelReadResult_error_body(peek_result.ipc_status,
-                                             peek_result.error.detail, error);
+    if (IpcBufferWritevResult_is_error_has_body(write_result.error)) {
+      const IpcBufferWritevError b = write_result.error.body;
+      error.offset = b.offset;
+      error.requested_size = b.requested_size;
+      error.available_contiguous = b.available_contiguous;
+      error.buffer_size = b.buffer_size;
     }
 
-    struct timespec curr_time;
-    if (clock_gettime(CLOCK_MONOTONIC, &curr_time) != 0) {
-      free(read_entry.payload);
-      error.sys_errno = errno;
-      error.offset = peek_entry.offset;
-      return IpcChannelReadResult_error_body(
-          IPC_ERR_SYSTEM, "system error: clock_gettime failed", error);
-    }
-
-    const uint64_t curr_ns = ipc_timespec_to_nanos(&curr_time);
-    const uint64_t elapsed_ns = curr_ns - start_ns;
-    if (elapsed_ns >= timeout_ns) {
-      free(read_entry.payload);
-      error.offset = peek_entry.offset;
-      return IpcChannelReadResult_error_body(IPC_ERR_TIMEOUT,
-                                             "timeout: read timed out", error);
-    }
-
-    const uint64_t remaining_ns = timeout_ns - elapsed_ns;
-    struct timespec remaining_timeout = {.tv_sec = remaining_ns / NANOS_PER_SEC,
-                                         .tv_nsec =
-                                             remaining_ns % NANOS_PER_SEC};
-
-    uint32_t expected_notify = atomic_load(&channel->header->notify);
-    int wait_res = ipc_futex_wait(&channel->header->notify, expected_notify,
-                                  &remaining_timeout);
-    if (wait_res != 0 && wait_res != ETIMEDOUT) {
-      free(read_entry.payload);
-      error.sys_errno = errno;
-      error.offset = peek_entry.offset;
-      return IpcChannelReadResult_error_body(
-          IPC_ERR_SYSTEM, "system error: futex wait failed", error);
-    }
+    return IpcChannelWritevResult_error_body(write_result.ipc_status,
+                                             write_result.error.detail, error);
   }
+
+  _notify(channel, 1);
+
+  return IpcChannelWritevResult_ok(write_result.ipc_status);
 }
 
-IpcChannelPeekResult ipc_channel_peek(const IpcChannel *channel,
-                                      IpcEntry *dest) {
-  IpcChannelPeekError error = {.offset = 0};
+IpcChannelWriteBatchResult ipc_channel_write_batch(IpcChannel *channel,
+                                                   const IpcMessage *messages,
+                                                   const size_t count) {
+  IpcChannelWriteBatchError error = {
+      .offset = 0, .index = 0, .required_size = 0, .buffer_size = 0};
+
   if (channel == NULL) {
-    return IpcChannelPeekResult_error_body(
+    return IpcChannelWriteBatchResult_error_body(
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
   }
 
   if (channel->buffer == NULL) {
-    return IpcChannelPeekResult_error_body(
+    return IpcChannelWriteBatchResult_error_body(
         IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
   }
 
-  if (dest == NULL) {
-    return IpcChannelPeekResult_error_body(
-        IPC_ERR_INVALID_ARGUMENT, "invalid argument: dest is NULL", error);
-  }
+  const IpcBufferWriteBatchResult write_result =
+      ipc_buffer_write_batch(channel->buffer, messages, count);
+  if (IpcBufferWriteBatchResult_is_error(write_result)) {
+    if (write_result.ipc_status == IPC_ERR_NO_SPACE_CONTIGUOUS) {
+      _notify(channel, 1);
+    }
 
-  const IpcBufferPeekResult peek_result =
-      ipc_buffer_peek(channel->buffer, dest);
-  if (IpcBufferPeekResult_is_error(peek_result)) {
-    error.offset = peek_result.error.body.offset;
-    return IpcChannelPeekResult_error_body(peek_result.ipc_status,
-                                           peek_result.error.detail, error);
+    if (IpcBufferWriteBatchResult_is_error_has_body(write_result.error)) {
+      const IpcBufferWriteBatchError b = write_result.error.body;
+      error.offset = b.offset;
+      error.index = b.index;
+      error.required_size = b.required_size;
+      error.buffer_size = b.buffer_size;
+    }
+
+    return IpcChannelWriteBatchResult_error_body(
+        write_result.ipc_status, write_result.error.detail, error);
   }
 
-  return IpcChannelPeekResult_ok(peek_result.ipc_status);
+  // one syscall for the whole batch, at most one consumer per entry
+  _notify(channel, write_result.result);
+
+  return IpcChannelWriteBatchResult_ok(write_result.ipc_status,
+                                       write_result.result);
 }
 
-IpcChannelSkipResult ipc_channel_skip(IpcChannel *channel,
-                                      const uint64_t offset) {
-  IpcChannelSkipError error = {.offset = offset};
+IpcChannelReserveResult ipc_channel_reserve(IpcChannel *channel,
+                                            const size_t size, IpcSlot *slot) {
+  IpcChannelReserveError error = {.offset = 0,
+                                  .requested_size = size,
+                                  .available_contiguous = 0,
+                                  .buffer_size = 0};
+
   if (channel == NULL) {
-    return IpcChannelSkipResult_error_body(
+    return IpcChannelReserveResult_error_body(
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
   }
 
   if (channel->buffer == NULL) {
-    return IpcChannelSkipResult_error_body(
+    return IpcChannelReserveResult_error_body(
         IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
   }
 
-  const IpcBufferSkipResult skip_result =
-      ipc_buffer_skip(channel->buffer, offset);
-  if (IpcBufferSkipResult_is_error(skip_result)) {
-    error.offset = skip_result.error.body.offset;
-    return IpcChannelSkipResult_error_body(skip_result.ipc_status,
-                                           skip_result.error.detail, error);
+  const IpcBufferReserveResult reserve_result =
+      ipc_buffer_reserve(channel->buffer, size, slot);
+  if (IpcBufferReserveResult_is_error(reserve_result)) {
+    if (reserve_result.ipc_status == IPC_ERR_NO_SPACE_CONTIGUOUS) {
+      _notify(channel, 1);
+    }
+
+    if (IpcBufferReserveResult_is_error_has_body(reserve_result.error)) {
+      const IpcBufferReserveError b = reserve_result.error.body;
+      error.offset = b.offset;
+      error.requested_size = b.requested_size;
+      error.available_contiguous = b.available_contiguous;
+      error.buffer_size = b.buffer_size;
+    }
+
+    return IpcChannelReserveResult_error_body(
+        reserve_result.ipc_status, reserve_result.error.detail, error);
   }
 
-  return IpcChannelSkipResult_ok(skip_result.ipc_status, skip_result.result);
+  return IpcChannelReserveResult_ok(reserve_result.ipc_status);
 }
 
-IpcChannelSkipForceResult ipc_channel_skip_force(IpcChannel *channel) {
-  IpcChannelSkipForceError error = {._unit = false};
+IpcChannelCommitResult ipc_channel_commit(IpcChannel *channel,
+                                          const IpcSlot *slot) {
+  IpcChannelCommitError error = {.offset = 0};
+
   if (channel == NULL) {
-    return IpcChannelSkipForceResult_error_body(
+    return IpcChannelCommitResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->buffer == NULL) {
+    return IpcChannelCommitResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
+
+  const IpcBufferCommitResult commit_result =
+      ipc_buffer_commit(channel->buffer, slot);
+  if (IpcBufferCommitResult_is_error(commit_result)) {
+    if (IpcBufferCommitResult_is_error_has_body(commit_result.error)) {
+      error.offset = commit_result.error.body.offset;
+    }
+
+    return IpcChannelCommitResult_error_body(
+        commit_result.ipc_status, commit_result.error.detail, error);
+  }
+
+  _notify(channel, 1);
+
+  return IpcChannelCommitResult_ok(commit_result.ipc_status);
+}
+
+IpcChannelAbortResult ipc_channel_abort(IpcChannel *channel,
+                                        const IpcSlot *slot) {
+  IpcChannelAbortError error = {.offset = 0};
+
+  if (channel == NULL) {
+    return IpcChannelAbortResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->buffer == NULL) {
+    return IpcChannelAbortResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
+
+  const IpcBufferAbortResult abort_result =
+      ipc_buffer_abort(channel->buffer, slot);
+  if (IpcBufferAbortResult_is_error(abort_result)) {
+    if (IpcBufferAbortResult_is_error_has_body(abort_result.error)) {
+      error.offset = abort_result.error.body.offset;
+    }
+
+    return IpcChannelAbortResult_error_body(abort_result.ipc_status,
+                                            abort_result.error.detail, error);
+  }
+
+  return IpcChannelAbortResult_ok(abort_result.ipc_status);
+}
+
+IpcChannelTryReadResult ipc_channel_try_read(IpcChannel *channel,
+                                             IpcEntry *dest) {
+  IpcChannelTryReadError error = {.offset = 0};
+
+  if (channel == NULL) {
+    return IpcChannelTryReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->buffer == NULL) {
+    return IpcChannelTryReadResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
+
+  if (dest == NULL) {
+    return IpcChannelTryReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: dest is NULL", error);
+  }
+
+  IpcEntry read_entry = {.offset = 0, .payload = NULL, .size = 0};
+  const IpcChannelReadResult read_result = _try_read(channel, &read_entry);
+  if (read_result.ipc_status == IPC_OK) {
+    dest->payload = read_entry.payload;
+    dest->size = read_entry.size;
+    dest->offset = read_entry.offset;
+  }
+
+  if (IpcChannelReadResult_is_error(read_result)) {
+    error.offset = read_result.error.body.offset;
+    return IpcChannelTryReadResult_error_body(read_result.ipc_status,
+                                              read_result.error.detail, error);
+  }
+
+  return IpcChannelTryReadResult_ok(read_result.ipc_status);
+}
+
+IpcChannelSelectResult ipc_channel_select(IpcChannel *const *channels,
+                                          const size_t count,
+                                          const struct timespec *timeout,
+                                          uint64_t *ready_mask) {
+  IpcChannelSelectError error = {
+      .index = 0, .timeout_used = {0, 0}, .sys_errno = 0};
+
+  if (channels == NULL) {
+    return IpcChannelSelectResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channels is NULL", error);
+  }
+
+  if (ready_mask == NULL) {
+    return IpcChannelSelectResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: ready_mask is NULL",
+        error);
+  }
+
+  if (count == 0 || count > IPC_CHANNEL_SELECT_MAX) {
+    return IpcChannelSelectResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: count must be {0 < count <= "
+        "IPC_CHANNEL_SELECT_MAX}",
+        error);
+  }
+
+  if (timeout == NULL) {
+    return IpcChannelSelectResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: timeout is NULL", error);
+  }
+
+  if (timeout->tv_nsec < 0 || timeout->tv_sec < 0) {
+    return IpcChannelSelectResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: timeout must be {timeout->tv_nsec >= 0 && "
+        "timeout->tv_sec >= 0}",
+        error);
+  }
+
+  error.timeout_used = *timeout;
+
+  uint64_t deadline_ns;
+  if (!_deadline_after(timeout, &deadline_ns)) {
+    error.sys_errno = errno;
+    return IpcChannelSelectResult_error_body(
+        IPC_ERR_SYSTEM, "system error: clock_gettime failed", error);
+  }
+
+  return _select_until(channels, count, deadline_ns, ready_mask, error);
+}
+
+IpcChannelSelectResult ipc_channel_select_until(IpcChannel *const *channels,
+                                                const size_t count,
+                                                const struct timespec *deadline,
+                                                uint64_t *ready_mask) {
+  IpcChannelSelectError error = {
+      .index = 0, .timeout_used = {0, 0}, .sys_errno = 0};
+
+  if (channels == NULL) {
+    return IpcChannelSelectResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channels is NULL", error);
+  }
+
+  if (ready_mask == NULL) {
+    return IpcChannelSelectResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: ready_mask is NULL",
+        error);
+  }
+
+  if (count == 0 || count > IPC_CHANNEL_SELECT_MAX) {
+    return IpcChannelSelectResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: count must be {0 < count <= "
+        "IPC_CHANNEL_SELECT_MAX}",
+        error);
+  }
+
+  if (deadline == NULL) {
+    return IpcChannelSelectResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: deadline is NULL", error);
+  }
+
+  if (deadline->tv_nsec < 0 || deadline->tv_sec < 0) {
+    return IpcChannelSelectResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: deadline must be {deadline->tv_nsec >= 0 && "
+        "deadline->tv_sec >= 0}",
+        error);
+  }
+
+  error.timeout_used = *deadline;
+
+  return _select_until(channels, count, ipc_timespec_to_nanos(deadline),
+                       ready_mask, error);
+}
+
+IpcChannelReadResult ipc_channel_read(IpcChannel *channel, IpcEntry *dest,
+                                      const struct timespec *timeout) {
+  IpcChannelReadError error = {.offset = 0, .timeout_used = {0, 0}};
+
+  if (channel == NULL) {
+    return IpcChannelReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->buffer == NULL) {
+    return IpcChannelReadResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
+
+  if (dest == NULL) {
+    return IpcChannelReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: dest is NULL", error);
+  }
+
+  if (timeout == NULL) {
+    return IpcChannelReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: timeout is NULL", error);
+  }
+
+  if (timeout->tv_nsec < 0 || timeout->tv_sec < 0) {
+    return IpcChannelReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: timeout must be {timeout->tv_nsec >= 0 && "
+        "timeout->tv_sec >= 0}",
+        error);
+  }
+
+  error.timeout_used = *timeout;
+
+  uint64_t deadline_ns;
+  if (!_deadline_after(timeout, &deadline_ns)) {
+    error.sys_errno = errno;
+    return IpcChannelReadResult_error_body(
+        IPC_ERR_SYSTEM, "system error: clock_gettime failed", error);
+  }
+
+  return _read_until(channel, dest, deadline_ns, error);
+}
+
+IpcChannelReadResult ipc_channel_read_until(IpcChannel *channel,
+                                            IpcEntry *dest,
+                                            const struct timespec *deadline) {
+  IpcChannelReadError error = {.offset = 0, .timeout_used = {0, 0}};
+
+  if (channel == NULL) {
+    return IpcChannelReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->buffer == NULL) {
+    return IpcChannelReadResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
+
+  if (dest == NULL) {
+    return IpcChannelReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: dest is NULL", error);
+  }
+
+  if (deadline == NULL) {
+    return IpcChannelReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: deadline is NULL", error);
+  }
+
+  if (deadline->tv_nsec < 0 || deadline->tv_sec < 0) {
+    return IpcChannelReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: deadline must be {deadline->tv_nsec >= 0 && "
+        "deadline->tv_sec >= 0}",
+        error);
+  }
+
+  error.timeout_used = *deadline;
+
+  return _read_until(channel, dest, ipc_timespec_to_nanos(deadline), error);
+}
+
+IpcChannelReadIntoResult ipc_channel_read_into(IpcChannel *channel, void *buf,
+                                               const size_t cap, size_t *len,
+                                               const struct timespec *timeout) {
+  IpcChannelReadIntoError error = {
+      .offset = 0, .required_size = 0, .timeout_used = {0, 0}};
+
+  if (channel == NULL) {
+    return IpcChannelReadIntoResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->buffer == NULL) {
+    return IpcChannelReadIntoResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
+
+  if (buf == NULL) {
+    return IpcChannelReadIntoResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: buf is NULL", error);
+  }
+
+  if (len == NULL) {
+    return IpcChannelReadIntoResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: len is NULL", error);
+  }
+
+  if (timeout == NULL) {
+    return IpcChannelReadIntoResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: timeout is NULL", error);
+  }
+
+  if (timeout->tv_nsec < 0 || timeout->tv_sec < 0) {
+    return IpcChannelReadIntoResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: timeout must be {timeout->tv_nsec >= 0 && "
+        "timeout->tv_sec >= 0}",
+        error);
+  }
+
+  error.timeout_used = *timeout;
+
+  uint64_t deadline_ns;
+  if (!_deadline_after(timeout, &deadline_ns)) {
+    error.sys_errno = errno;
+    return IpcChannelReadIntoResult_error_body(
+        IPC_ERR_SYSTEM, "system error: clock_gettime failed", error);
+  }
+
+  // no peek first: ipc_buffer_read sizes the entry against cap itself and
+  // leaves it in place when it does not fit
+  IpcChannelReadIntoResult result;
+  WaitState wait = {.waiters = &channel->header->notify_waiters,
+                    .rounds = 0,
+                    .parked = false,
+                    .expired = false};
+  for (;;) {
+    const uint32_t expected_notify = atomic_load(&channel->header->notify);
+    IpcEntry dest = {.offset = 0, .payload = buf, .size = cap};
+    const IpcBufferReadResult read_result =
+        ipc_buffer_read(channel->buffer, &dest);
+    if (read_result.ipc_status == IPC_OK) {
+      _consumed(channel);
+
+      *len = dest.size;
+      result = IpcChannelReadIntoResult_ok(IPC_OK);
+      break;
+    }
+
+    if (!_is_retry_status(read_result.ipc_status)) {
+      error.offset = read_result.error.body.offset;
+      error.required_size = read_result.error.body.required_size;
+      result = IpcChannelReadIntoResult_error_body(
+          read_result.ipc_status, read_result.error.detail, error);
+      break;
+    }
+
+    const IpcStatus wait_status =
+        _wait(channel, &channel->header->notify, expected_notify,
+              deadline_ns, &wait, &error.sys_errno);
+    if (wait_status == IPC_ERR_TIMEOUT) {
+      result = IpcChannelReadIntoResult_error_body(
+          IPC_ERR_TIMEOUT, "timeout: read timed out", error);
+      break;
+    }
+
+    if (wait_status != IPC_OK) {
+      result = IpcChannelReadIntoResult_error_body(
+          wait_status, "system error: futex wait failed", error);
+      break;
+    }
+  }
+  _wait_end(channel, &wait, IpcChannelReadIntoResult_is_ok(result));
+
+  return result;
+}
+
+IpcChannelDrainResult ipc_channel_drain(IpcChannel *channel,
+                                        IpcEntryCallback callback, void *ctx,
+                                        const size_t max_entries,
+                                        const struct timespec *timeout) {
+  IpcChannelDrainError error = {
+      .offset = 0, .timeout_used = {0, 0}, .sys_errno = 0};
+
+  if (channel == NULL) {
+    return IpcChannelDrainResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->buffer == NULL) {
+    return IpcChannelDrainResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
+
+  if (timeout == NULL) {
+    return IpcChannelDrainResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: timeout is NULL", error);
+  }
+
+  if (timeout->tv_nsec < 0 || timeout->tv_sec < 0) {
+    return IpcChannelDrainResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: timeout must be {timeout->tv_nsec >= 0 && "
+        "timeout->tv_sec >= 0}",
+        error);
+  }
+
+  error.timeout_used = *timeout;
+
+  uint64_t deadline_ns;
+  if (!_deadline_after(timeout, &deadline_ns)) {
+    error.sys_errno = errno;
+    return IpcChannelDrainResult_error_body(
+        IPC_ERR_SYSTEM, "system error: clock_gettime failed", error);
+  }
+
+  return _drain_until(channel, callback, ctx, max_entries, deadline_ns,
+                      error);
+}
+
+IpcChannelDrainResult ipc_channel_drain_until(IpcChannel *channel,
+                                              IpcEntryCallback callback,
+                                              void *ctx,
+                                              const size_t max_entries,
+                                              const struct timespec *deadline) {
+  IpcChannelDrainError error = {
+      .offset = 0, .timeout_used = {0, 0}, .sys_errno = 0};
+
+  if (channel == NULL) {
+    return IpcChannelDrainResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->buffer == NULL) {
+    return IpcChannelDrainResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
+
+  if (deadline == NULL) {
+    return IpcChannelDrainResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: deadline is NULL", error);
+  }
+
+  if (deadline->tv_nsec < 0 || deadline->tv_sec < 0) {
+    return IpcChannelDrainResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: deadline must be {deadline->tv_nsec >= 0 && "
+        "deadline->tv_sec >= 0}",
+        error);
+  }
+
+  error.timeout_used = *deadline;
+
+  return _drain_until(channel, callback, ctx, max_entries,
+                      ipc_timespec_to_nanos(deadline), error);
+}
+
+IpcChannelAcquireResult ipc_channel_acquire(IpcChannel *channel,
+                                            IpcEntry *dest,
+                                            const struct timespec *timeout) {
+  IpcChannelAcquireError error = {
+      .offset = 0, .timeout_used = {0, 0}, .sys_errno = 0};
+
+  if (channel == NULL) {
+    return IpcChannelAcquireResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->buffer == NULL) {
+    return IpcChannelAcquireResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
+
+  if (dest == NULL) {
+    return IpcChannelAcquireResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: dest is NULL", error);
+  }
+
+  if (timeout == NULL) {
+    return IpcChannelAcquireResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: timeout is NULL", error);
+  }
+
+  if (timeout->tv_nsec < 0 || timeout->tv_sec < 0) {
+    return IpcChannelAcquireResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: timeout must be {timeout->tv_nsec >= 0 && "
+        "timeout->tv_sec >= 0}",
+        error);
+  }
+
+  error.timeout_used = *timeout;
+
+  uint64_t deadline_ns;
+  if (!_deadline_after(timeout, &deadline_ns)) {
+    error.sys_errno = errno;
+    return IpcChannelAcquireResult_error_body(
+        IPC_ERR_SYSTEM, "system error: clock_gettime failed", error);
+  }
+
+  return _acquire_until(channel, dest, deadline_ns, error);
+}
+
+IpcChannelAcquireResult
+ipc_channel_acquire_until(IpcChannel *channel, IpcEntry *dest,
+                          const struct timespec *deadline) {
+  IpcChannelAcquireError error = {
+      .offset = 0, .timeout_used = {0, 0}, .sys_errno = 0};
+
+  if (channel == NULL) {
+    return IpcChannelAcquireResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->buffer == NULL) {
+    return IpcChannelAcquireResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
+
+  if (dest == NULL) {
+    return IpcChannelAcquireResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: dest is NULL", error);
+  }
+
+  if (deadline == NULL) {
+    return IpcChannelAcquireResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: deadline is NULL", error);
+  }
+
+  if (deadline->tv_nsec < 0 || deadline->tv_sec < 0) {
+    return IpcChannelAcquireResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: deadline must be {deadline->tv_nsec >= 0 && "
+        "deadline->tv_sec >= 0}",
+        error);
+  }
+
+  error.timeout_used = *deadline;
+
+  return _acquire_until(channel, dest, ipc_timespec_to_nanos(deadline), error);
+}
+
+IpcChannelReleaseResult ipc_channel_release(IpcChannel *channel,
+                                            const IpcEntry *entry) {
+  IpcChannelReleaseError error = {.offset = 0};
+
+  if (channel == NULL) {
+    return IpcChannelReleaseResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->buffer == NULL) {
+    return IpcChannelReleaseResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
+
+  const IpcBufferReleaseResult release_result =
+      ipc_buffer_release(channel->buffer, entry);
+  if (IpcBufferReleaseResult_is_error(release_result)) {
+    if (IpcBufferReleaseResult_is_error_has_body(release_result.error)) {
+      error.offset = release_result.error.body.offset;
+    }
+
+    return IpcChannelReleaseResult_error_body(
+        release_result.ipc_status, release_result.error.detail, error);
+  }
+
+  _consumed(channel);
+
+  return IpcChannelReleaseResult_ok(release_result.ipc_status);
+}
+
+IpcChannelPeekResult ipc_channel_peek(const IpcChannel *channel,
+                                      IpcEntry *dest) {
+  IpcChannelPeekError error = {.offset = 0};
+  if (channel == NULL) {
+    return IpcChannelPeekResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->buffer == NULL) {
+    return IpcChannelPeekResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
+
+  if (dest == NULL) {
+    return IpcChannelPeekResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: dest is NULL", error);
+  }
+
+  const IpcBufferPeekResult peek_result =
+      ipc_buffer_peek(channel->buffer, dest);
+  if (IpcBufferPeekResult_is_error(peek_result)) {
+    error.offset = peek_result.error.body.offset;
+    return IpcChannelPeekResult_error_body(peek_result.ipc_status,
+                                           peek_result.error.detail, error);
+  }
+
+  return IpcChannelPeekResult_ok(peek_result.ipc_status);
+}
+
+IpcChannelSkipResult ipc_channel_skip(IpcChannel *channel,
+                                      const uint64_t offset) {
+  IpcChannelSkipError error = {.offset = offset};
+  if (channel == NULL) {
+    return IpcChannelSkipResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
+  }
+
+  if (channel->buffer == NULL) {
+    return IpcChannelSkipResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: channel->buffer is NULL", error);
+  }
+
+  const IpcBufferSkipResult skip_result =
+      ipc_buffer_skip(channel->buffer, offset);
+  if (IpcBufferSkipResult_is_error(skip_result)) {
+    error.offset = skip_result.error.body.offset;
+    return IpcChannelSkipResult_error_body(skip_result.ipc_status,
+                                           skip_result.error.detail, error);
+  }
+
+  if (skip_result.ipc_status == IPC_OK) {
+    _consumed(channel);
+  }
+
+  return IpcChannelSkipResult_ok(skip_result.ipc_status, skip_result.result);
+}
+
+IpcChannelSkipForceResult ipc_channel_skip_force(IpcChannel *channel) {
+  IpcChannelSkipForceError error = {._unit = false};
+  if (channel == NULL) {
+    return IpcChannelSkipForceResult_error_body(
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL", error);
   }
 
@@ -400,10 +1342,48 @@ IpcChannelSkipForceResult ipc_channel_skip_force(IpcChannel *channel) {
         skip_result.ipc_status, skip_result.error.detail, error);
   }
 
+  if (skip_result.ipc_status == IPC_OK) {
+    _consumed(channel);
+  }
+
   return IpcChannelSkipForceResult_ok(skip_result.ipc_status,
                                       skip_result.result);
 }
 
+// options == NULL accepts the buffer in whatever mode it was created
+static IpcChannelConnectResult _connect(void *mem,
+                                        const IpcBufferOptions *options) {
+  const size_t min_total = ipc_channel_get_memory_overhead();
+  IpcChannelConnectError error = {.min_size = min_total};
+
+  if (mem == NULL) {
+    return IpcChannelConnectResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: mem is NULL", error);
+  }
+
+  IpcChannel *channel = (IpcChannel *)malloc(sizeof(IpcChannel));
+  if (channel == NULL) {
+    error.sys_errno = errno;
+    return IpcChannelConnectResult_error_body(
+        IPC_ERR_SYSTEM, "system error: channel allocation failed", error);
+  }
+
+  uint8_t *buffer_memory = ((uint8_t *)mem) + CHANNEL_HEADER_SIZE_ALIGNED;
+  const IpcBufferAttachResult buffer_result =
+      options == NULL
+          ? ipc_buffer_attach((void *)buffer_memory)
+          : ipc_buffer_attach_with_options((void *)buffer_memory, options);
+  if (IpcBufferAttachResult_is_error(buffer_result)) {
+    free(channel);
+    return IpcChannelConnectResult_error_body(
+        buffer_result.ipc_status, buffer_result.error.detail, error);
+  }
+
+  _init_handle(channel, (IpcChannelHeader *)mem, buffer_result.result);
+
+  return IpcChannelConnectResult_ok(IPC_OK, channel);
+}
+
 static IpcChannelReadResult _try_read(IpcChannel *channel, IpcEntry *dest) {
   IpcChannelReadError error = {.offset = 0, .timeout_used = {0, 0}};
 
@@ -422,65 +1402,691 @@ static IpcChannelReadResult _try_read(IpcChannel *channel, IpcEntry *dest) {
         IPC_ERR_INVALID_ARGUMENT, "invalid argument: data is NULL", error);
   }
 
-  for (;;) {
-    IpcEntry peek_entry;
-    const IpcBufferPeekResult peek_result =
-        ipc_buffer_peek(channel->buffer, &peek_entry);
+  // one pass over the head: the payload is allocated once the entry is
+  // claimed, no peek for its size first
+  PayloadSizing sizing = {.channel = channel, .payload = NULL, .capacity = 0};
+  const IpcBufferReadResult read_result =
+      ipc_buffer_read_sized(channel->buffer, dest, _size_payload, &sizing);
+  if (read_result.ipc_status == IPC_OK) {
+    _consumed(channel);
+    return IpcChannelReadResult_ok(IPC_OK);
+  }
 
-    if (IpcBufferPeekResult_is_error(peek_result)) {
-      error.offset = peek_entry.offset;
-      return IpcChannelReadResult_error_body(peek_result.ipc_status,
-                                             peek_result.error.detail, error);
+  // handed back only along with an entry
+  _free_payload(channel, sizing.payload);
+  dest->payload = NULL;
+
+  if (IpcBufferReadResult_is_error(read_result)) {
+    error.offset = read_result.error.body.offset;
+    if (read_result.ipc_status == IPC_ERR_SYSTEM) {
+      error.sys_errno = errno;
     }
+    return IpcChannelReadResult_error_body(read_result.ipc_status,
+                                           read_result.error.detail, error);
+  }
+
+  return IpcChannelReadResult_ok(read_result.ipc_status);
+}
+
+static inline bool _is_error_status(const IpcStatus status) {
+  return status != IPC_OK && !_is_retry_status(status);
+}
+
+static inline bool _is_retry_status(const IpcStatus status) {
+  return status == IPC_ERR_NOT_READY || status == IPC_EMPTY ||
+         status == IPC_ERR_CORRUPTED || status == IPC_ERR_LOCKED;
+}
+
+// One wait between two attempts of a blocking call, shaped by the handle's
+// strategy. A futex sleep ends at the deadline on its own, so the clock is
+// only read when spinning, and every DEADLINE_CHECK_ROUNDS rounds in case the
+// word keeps changing under a sleeper that makes no progress.
+static IpcStatus _wait(IpcChannel *channel, _Atomic uint32_t *word,
+                       const uint32_t expected, const uint64_t deadline_ns,
+                       WaitState *state, int *sys_errno) {
+  // the attempt after the sleep that hit the deadline was the last one
+  if (state->expired) {
+    return IPC_ERR_TIMEOUT;
+  }
 
-    if (peek_result.ipc_status != IPC_OK) {
-      return IpcChannelReadResult_ok(peek_result.ipc_status);
+  const bool spinning = state->rounds < channel->wait.spin_limit;
+  const bool sleeps =
+      channel->wait.kind == IPC_WAIT_FUTEX ||
+      (channel->wait.kind == IPC_WAIT_SPIN_FUTEX && !spinning);
+  if (!sleeps || state->rounds % DEADLINE_CHECK_ROUNDS == 0 ||
+      state->rounds == UINT32_MAX) {
+    struct timespec curr_time;
+    if (clock_gettime(CLOCK_MONOTONIC, &curr_time) != 0) {
+      *sys_errno = errno;
+      return IPC_ERR_SYSTEM;
     }
 
-    if (dest->payload == NULL) {
-      dest->payload = malloc(peek_entry.size);
-      if (dest->payload == NULL) {
-        error.offset = peek_entry.offset;
-        error.sys_errno = errno;
-        return IpcChannelReadResult_error_body(
-            IPC_ERR_SYSTEM, "system error: allocation failed", error);
-      }
+    if (ipc_timespec_to_nanos(&curr_time) >= deadline_ns) {
+      return IPC_ERR_TIMEOUT;
+    }
+  }
 
-      dest->size = peek_entry.size;
-    } else if (dest->size < peek_entry.size) {
-      void *new_buf = realloc(dest->payload, peek_entry.size);
-      if (new_buf == NULL) {
-        error.sys_errno = errno;
-        error.offset = peek_entry.offset;
-        return IpcChannelReadResult_error_body(
-            IPC_ERR_SYSTEM, "system error: allocation failed", error);
+  if (state->rounds < UINT32_MAX) {
+    state->rounds++;
+  }
+
+  switch (channel->wait.kind) {
+  case IPC_WAIT_BUSY_SPIN:
+    ipc_cpu_relax();
+    return IPC_OK;
+  case IPC_WAIT_SPIN_YIELD:
+    if (spinning) {
+      ipc_cpu_relax();
+    } else {
+      sched_yield();
+    }
+    return IPC_OK;
+  case IPC_WAIT_SPIN_FUTEX:
+    if (spinning) {
+      ipc_cpu_relax();
+      return IPC_OK;
+    }
+    break;
+  case IPC_WAIT_FUTEX:
+    break;
+  }
+
+  // The first time the call would sleep it only announces itself and goes
+  // for one more attempt. That attempt is ordered after the increment by the
+  // fence, which pairs with the one in _notify: either it sees the entry or
+  // the producer sees the waiter and bumps the word.
+  if (state->waiters != NULL && !state->parked) {
+    atomic_fetch_add(state->waiters, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    state->parked = true;
+    return IPC_OK;
+  }
+
+  const struct timespec deadline = {.tv_sec = deadline_ns / NANOS_PER_SEC,
+                                    .tv_nsec = deadline_ns % NANOS_PER_SEC};
+  const int wait_res = ipc_futex_wait_until(word, expected, &deadline);
+  if (wait_res == ETIMEDOUT) {
+    state->expired = true;
+  } else if (wait_res != 0) {
+    *sys_errno = wait_res;
+    return IPC_ERR_SYSTEM;
+  }
+
+  return IPC_OK;
+}
+
+// Called on every exit of a blocking call that waited through _wait. A
+// consumer that was parked and leaves without an entry may have taken the
+// wakeup meant for another one, and passes it on.
+static inline void _wait_end(IpcChannel *channel, WaitState *state,
+                             const bool consumed) {
+  if (!state->parked) {
+    return;
+  }
+
+  atomic_fetch_sub(state->waiters, 1);
+  if (!consumed) {
+    _pass_on(channel);
+  }
+}
+
+// Producers, after publishing entries: wakes one parked consumer per entry,
+// a woken consumer passes the rest on in _consumed. Broadcast subscribers
+// each read every entry, so there everybody is woken. The fence orders the
+// publish before the waiter checks, it pairs with the one in _wait (and in
+// ipc_channel_select, ipc_channel_arm_readiness). With nobody parked a wakeup
+// is a few loads and no syscall.
+static void _notify(IpcChannel *channel, const size_t entries) {
+  atomic_thread_fence(memory_order_seq_cst);
+  const uint32_t waiters = atomic_load_explicit(
+      &channel->header->notify_waiters, memory_order_relaxed);
+  const uint32_t watchers = atomic_load_explicit(
+      &channel->header->notify_watchers, memory_order_relaxed);
+  if (waiters == 0 && watchers == 0 &&
+      atomic_load_explicit(&channel->header->ready_armed,
+                           memory_order_relaxed) == 0) {
+    return;
+  }
+
+  _wake(channel, waiters, watchers, entries);
+}
+
+// Consumers, after moving the head: frees parked producers and passes the
+// wakeup on while a backlog is left.
+static void _consumed(IpcChannel *channel) {
+  _signal_space(channel);
+  _pass_on(channel);
+}
+
+// Chain-wakes the next parked consumer while a backlog is left. That consumer
+// may have been woken for an entry this one took, or seen the head locked by
+// us. Also for a parked call that leaves without taking the entry it may have
+// been woken for. Broadcast can not tell who shares this cursor, so it wakes
+// everybody.
+static void _pass_on(IpcChannel *channel) {
+  const uint32_t waiters = atomic_load_explicit(
+      &channel->header->notify_waiters, memory_order_relaxed);
+  const uint32_t watchers = atomic_load_explicit(
+      &channel->header->notify_watchers, memory_order_relaxed);
+  if (waiters == 0 && watchers == 0) {
+    return;
+  }
+
+  IpcEntry next;
+  if (ipc_buffer_peek(channel->buffer, &next).ipc_status != IPC_OK) {
+    return;
+  }
+
+  _wake(channel, waiters, watchers, 1);
+}
+
+// An armed readiness descriptor is fired on top of the futex wakeup, its
+// owner sleeps in epoll and takes no wakeup from a parked consumer. A
+// targeted wake could land on a select caller that takes nothing and leave a
+// reader asleep, so it is used only while no select caller is parked.
+static void _wake(IpcChannel *channel, const uint32_t waiters,
+                  const uint32_t watchers, const size_t entries) {
+  if (atomic_load_explicit(&channel->header->ready_armed,
+                           memory_order_relaxed) != 0) {
+    _signal_ready(channel);
+  }
+
+  if (waiters == 0 && watchers == 0) {
+    return;
+  }
+
+  atomic_fetch_add(&channel->header->notify, 1);
+  if (channel->broadcast || watchers > 0) {
+    ipc_futex_wake_all(&channel->header->notify);
+  } else if (entries == 1) {
+    ipc_futex_wake_one(&channel->header->notify);
+  } else {
+    ipc_futex_wake_n(&channel->header->notify,
+                     entries < waiters ? (uint32_t)entries : waiters);
+  }
+}
+
+// Whoever flips the flag fires the descriptor.
+static bool _disarm(IpcChannel *channel) {
+  return atomic_exchange(&channel->header->ready_armed, 0) != 0;
+}
+
+// Disarms and fires the descriptor, unless it was disarmed already or is out
+// of reach. Other handles write through a copy of the owner's
+// descriptor, taken once per owner: a copy taken while the owner changed may
+// be of an unrelated descriptor and is dropped, one that failed is not tried
+// again before the owner changes and the failure is left for the owner.
+static void _signal_ready(IpcChannel *channel) {
+  if (channel->ready_fd >= 0) {
+    if (_disarm(channel)) {
+      ipc_eventfd_signal(channel->ready_fd);
+    }
+    return;
+  }
+
+  bool unlocked = false;
+  while (!atomic_compare_exchange_weak_explicit(
+      &channel->ready_lock, &unlocked, true, memory_order_acquire,
+      memory_order_relaxed)) {
+    unlocked = false;
+    ipc_cpu_relax();
+  }
+
+  const uint32_t gen = atomic_load_explicit(&channel->header->ready_gen,
+                                            memory_order_acquire);
+  if (channel->ready_copy_gen != gen) {
+    if (channel->ready_copy >= 0) {
+      close(channel->ready_copy);
+    }
+
+    int copy = ipc_eventfd_import(atomic_load(&channel->header->ready_pid),
+                                  atomic_load(&channel->header->ready_fd));
+    const int import_errno = errno;
+    if (atomic_load_explicit(&channel->header->ready_gen,
+                             memory_order_acquire) != gen) {
+      if (copy >= 0) {
+        close(copy);
+        copy = -1;
       }
-      dest->payload = new_buf;
-      dest->size = peek_entry.size;
+    } else if (copy < 0) {
+      atomic_store(&channel->header->ready_fault,
+                   ((uint64_t)gen << 32) | (uint32_t)import_errno);
     }
+    channel->ready_copy = copy;
+    channel->ready_copy_gen = gen;
+  }
 
-    const IpcBufferReadResult read_result =
-        ipc_buffer_read(channel->buffer, dest);
+  if (channel->ready_copy >= 0 && _disarm(channel)) {
+    ipc_eventfd_signal(channel->ready_copy);
+  }
+
+  atomic_store_explicit(&channel->ready_lock, false, memory_order_release);
+}
+
+// errno of a producer that could not reach the descriptor of the current
+// owner, 0 if none
+static int _ready_fault(const IpcChannel *channel) {
+  const uint64_t fault = atomic_load(&channel->header->ready_fault);
+  if ((uint32_t)(fault >> 32) != atomic_load(&channel->header->ready_gen)) {
+    return 0;
+  }
+
+  return (int)(uint32_t)fault;
+}
+
+// Gives up ownership of the readiness descriptor (the generation moves before
+// it is closed, see _signal_ready) and closes this process' copy.
+static void _release_ready(IpcChannel *channel) {
+  if (channel->ready_copy >= 0) {
+    close(channel->ready_copy);
+    channel->ready_copy = -1;
+  }
+
+  if (channel->ready_fd < 0) {
+    return;
+  }
+
+  _disarm(channel);
+  atomic_store(&channel->header->ready_fd, -1);
+  atomic_fetch_add_explicit(&channel->header->ready_gen, 1,
+                            memory_order_release);
+  close(channel->ready_fd);
+  channel->ready_fd = -1;
+  atomic_store(&channel->header->ready_owned, 0);
+}
+
+static void _init_handle(IpcChannel *channel, IpcChannelHeader *header,
+                         IpcBuffer *buffer) {
+  channel->header = header;
+  channel->buffer = buffer;
+  channel->wait = (IpcWaitStrategy){.kind = IPC_WAIT_FUTEX, .spin_limit = 0};
+  channel->broadcast =
+      (ipc_buffer_get_flags(buffer) & IPC_BUFFER_BROADCAST) != 0;
+  channel->ready_fd = -1;
+  channel->ready_copy = -1;
+  channel->ready_copy_gen = 0;
+  atomic_init(&channel->ready_lock, false);
+  channel->pool = NULL;
+}
+
+// The fence orders the consumer's head update before the waiter checks here
+// and in _consumed. It pairs with the increment in ipc_channel_write_timed:
+// either the producer sees the freed space or the consumer sees the producer.
+// Likewise with the one in _wait for a consumer about to park.
+static void _signal_space(IpcChannel *channel) {
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&channel->header->space_waiters,
+                           memory_order_relaxed) == 0) {
+    return;
+  }
+
+  atomic_fetch_add(&channel->header->space, 1);
+  ipc_futex_wake_all(&channel->header->space);
+}
+
+// The only clock read of a blocking call that does not spin, the retry loop
+// works against the absolute deadline from here on.
+static bool _deadline_after(const struct timespec *timeout,
+                            uint64_t *deadline_ns) {
+  struct timespec now;
+  if (clock_gettime(CLOCK_MONOTONIC, &now) != 0) {
+    return false;
+  }
+
+  *deadline_ns = ipc_timespec_to_nanos(&now) + ipc_timespec_to_nanos(timeout);
+  return true;
+}
+
+static void *_alloc_payload(IpcChannel *channel, const size_t size,
+                            size_t *capacity) {
+  if (channel->pool != NULL) {
+    return ipc_payload_pool_alloc(channel->pool, size, capacity);
+  }
+
+  void *payload = malloc(size);
+  *capacity = size;
+  return payload;
+}
+
+static void _free_payload(IpcChannel *channel, void *payload) {
+  if (channel->pool != NULL) {
+    ipc_payload_pool_release(payload);
+  } else {
+    free(payload);
+  }
+}
+
+// Called again when the buffer read starts over, keeps the payload when it
+// is large enough.
+static void *_size_payload(size_t size, void *ctx) {
+  PayloadSizing *sizing = (PayloadSizing *)ctx;
+  if (sizing->payload != NULL && sizing->capacity >= size) {
+    return sizing->payload;
+  }
+
+  _free_payload(sizing->channel, sizing->payload);
+  sizing->payload = _alloc_payload(sizing->channel, size, &sizing->capacity);
+  return sizing->payload;
+}
+
+static IpcChannelWriteResult _write_until(IpcChannel *channel,
+                                          const void *data, const size_t size,
+                                          const uint64_t deadline_ns) {
+  // announced before the first attempt, a consumer freeing space after it
+  // failed is then bound to bump the space word
+  atomic_fetch_add(&channel->header->space_waiters, 1);
+  IpcChannelWriteResult result;
+  WaitState wait = {
+      .waiters = NULL, .rounds = 0, .parked = false, .expired = false};
+  for (;;) {
+    const uint32_t expected_space = atomic_load(&channel->header->space);
+    result = ipc_channel_write(channel, data, size);
+    if (result.ipc_status != IPC_ERR_NO_SPACE_CONTIGUOUS) {
+      break;
+    }
+
+    int sys_errno = 0;
+    const IpcStatus wait_status =
+        _wait(channel, &channel->header->space, expected_space, deadline_ns,
+              &wait, &sys_errno);
+    if (wait_status == IPC_ERR_TIMEOUT) {
+      result = IpcChannelWriteResult_error_body(
+          IPC_ERR_TIMEOUT, "timeout: write timed out", result.error.body);
+      break;
+    }
+
+    if (wait_status != IPC_OK) {
+      result = IpcChannelWriteResult_error_body(
+          wait_status, "system error: wait for space failed",
+          result.error.body);
+      break;
+    }
+  }
+  atomic_fetch_sub(&channel->header->space_waiters, 1);
+
+  return result;
+}
+
+static IpcChannelReadResult _read_until(IpcChannel *channel, IpcEntry *dest,
+                                        const uint64_t deadline_ns,
+                                        IpcChannelReadError error) {
+  IpcChannelReadResult result;
+  WaitState wait = {.waiters = &channel->header->notify_waiters,
+                    .rounds = 0,
+                    .parked = false,
+                    .expired = false};
+  for (;;) {
+    // loaded before the attempt, like in ipc_channel_acquire; a producer
+    // parked in ipc_channel_write_timed would not write again to wake us
+    const uint32_t expected_notify = atomic_load(&channel->header->notify);
+    IpcEntry read_entry = {.offset = 0, .payload = NULL, .size = 0};
+    result = _try_read(channel, &read_entry);
+    if (result.ipc_status == IPC_OK) {
+      dest->payload = read_entry.payload;
+      dest->size = read_entry.size;
+      dest->offset = read_entry.offset;
+      break;
+    }
 
-    if (IpcBufferReadResult_is_error(read_result)) {
-      if (read_result.ipc_status == IPC_ERR_TOO_SMALL) {
-        continue;
+    if (IpcChannelReadResult_is_error(result)) {
+      error.offset = result.error.body.offset;
+      if (_is_error_status(result.ipc_status)) {
+        error.sys_errno = result.error.body.sys_errno;
+        result = IpcChannelReadResult_error_body(result.ipc_status,
+                                                 result.error.detail, error);
+        break;
       }
+    }
 
-      error.offset = dest->offset;
-      return IpcChannelReadResult_error_body(read_result.ipc_status,
-                                             read_result.error.detail, error);
+    const IpcStatus wait_status =
+        _wait(channel, &channel->header->notify, expected_notify,
+              deadline_ns, &wait, &error.sys_errno);
+    if (wait_status == IPC_ERR_TIMEOUT) {
+      result = IpcChannelReadResult_error_body(
+          IPC_ERR_TIMEOUT, "timeout: read timed out", error);
+      break;
     }
 
-    return IpcChannelReadResult_ok(read_result.ipc_status);
+    if (wait_status != IPC_OK) {
+      result = IpcChannelReadResult_error_body(
+          wait_status, "system error: futex wait failed", error);
+      break;
+    }
   }
+  _wait_end(channel, &wait, IpcChannelReadResult_is_ok(result));
+
+  return result;
 }
 
-static inline bool _is_error_status(const IpcStatus status) {
-  return status != IPC_OK && !_is_retry_status(status);
+static IpcChannelDrainResult _drain_until(IpcChannel *channel,
+                                          IpcEntryCallback callback, void *ctx,
+                                          const size_t max_entries,
+                                          const uint64_t deadline_ns,
+                                          IpcChannelDrainError error) {
+  IpcChannelDrainResult result;
+  WaitState wait = {.waiters = &channel->header->notify_waiters,
+                    .rounds = 0,
+                    .parked = false,
+                    .expired = false};
+  for (;;) {
+    const uint32_t expected_notify = atomic_load(&channel->header->notify);
+    const IpcBufferReadBatchResult batch_result =
+        ipc_buffer_read_batch(channel->buffer, max_entries, callback, ctx);
+    if (batch_result.ipc_status == IPC_OK) {
+      _consumed(channel);
+
+      result = IpcChannelDrainResult_ok(IPC_OK, batch_result.result);
+      break;
+    }
+
+    if (!_is_retry_status(batch_result.ipc_status)) {
+      error.offset = batch_result.error.body.offset;
+      result = IpcChannelDrainResult_error_body(
+          batch_result.ipc_status, batch_result.error.detail, error);
+      break;
+    }
+
+    const IpcStatus wait_status =
+        _wait(channel, &channel->header->notify, expected_notify,
+              deadline_ns, &wait, &error.sys_errno);
+    if (wait_status == IPC_ERR_TIMEOUT) {
+      result = IpcChannelDrainResult_error_body(
+          IPC_ERR_TIMEOUT, "timeout: drain timed out", error);
+      break;
+    }
+
+    if (wait_status != IPC_OK) {
+      result = IpcChannelDrainResult_error_body(
+          wait_status, "system error: wait for entry failed", error);
+      break;
+    }
+  }
+  _wait_end(channel, &wait, IpcChannelDrainResult_is_ok(result));
+
+  return result;
 }
 
-static inline bool _is_retry_status(const IpcStatus status) {
-  return status == IPC_ERR_NOT_READY || status == IPC_EMPTY ||
-         status == IPC_ERR_CORRUPTED || status == IPC_ERR_LOCKED;
+static IpcChannelAcquireResult _acquire_until(IpcChannel *channel,
+                                              IpcEntry *dest,
+                                              const uint64_t deadline_ns,
+                                              IpcChannelAcquireError error) {
+  IpcChannelAcquireResult result;
+  WaitState wait = {.waiters = &channel->header->notify_waiters,
+                    .rounds = 0,
+                    .parked = false,
+                    .expired = false};
+  for (;;) {
+    // loaded before the attempt, so a write racing with it changes the
+    // value and the wait below returns immediately
+    const uint32_t expected_notify = atomic_load(&channel->header->notify);
+    const IpcBufferAcquireResult acquire_result =
+        ipc_buffer_acquire(channel->buffer, dest);
+    if (acquire_result.ipc_status == IPC_OK) {
+      result = IpcChannelAcquireResult_ok(IPC_OK);
+      break;
+    }
+
+    if (!_is_retry_status(acquire_result.ipc_status)) {
+      error.offset = acquire_result.error.body.offset;
+      result = IpcChannelAcquireResult_error_body(
+          acquire_result.ipc_status, acquire_result.error.detail, error);
+      break;
+    }
+
+    const IpcStatus wait_status =
+        _wait(channel, &channel->header->notify, expected_notify,
+              deadline_ns, &wait, &error.sys_errno);
+    if (wait_status == IPC_ERR_TIMEOUT) {
+      result = IpcChannelAcquireResult_error_body(
+          IPC_ERR_TIMEOUT, "timeout: acquire timed out", error);
+      break;
+    }
+
+    if (wait_status != IPC_OK) {
+      result = IpcChannelAcquireResult_error_body(
+          wait_status, "system error: wait for entry failed", error);
+      break;
+    }
+  }
+  _wait_end(channel, &wait, IpcChannelAcquireResult_is_ok(result));
+
+  return result;
+}
+
+static IpcChannelSelectResult _select_until(IpcChannel *const *channels,
+                                            const size_t count,
+                                            const uint64_t deadline_ns,
+                                            uint64_t *ready_mask,
+                                            IpcChannelSelectError error) {
+  _Atomic uint32_t *words[IPC_CHANNEL_SELECT_MAX];
+  for (size_t i = 0; i < count; i++) {
+    if (channels[i] == NULL || channels[i]->buffer == NULL) {
+      error.index = i;
+      return IpcChannelSelectResult_error_body(
+          IPC_ERR_INVALID_ARGUMENT, "invalid argument: channel is NULL",
+          error);
+    }
+
+    words[i] = &channels[i]->header->notify;
+  }
+
+  const struct timespec deadline = {.tv_sec = deadline_ns / NANOS_PER_SEC,
+                                    .tv_nsec = deadline_ns % NANOS_PER_SEC};
+
+  // Like _wait: the first time nothing is ready the call counts itself in
+  // every channel's notify_watchers, then checks once more before sleeping.
+  // futex_waitv ends at the deadline on its own, so the clock is only read
+  // when napping without it, and every DEADLINE_CHECK_ROUNDS rounds.
+  IpcChannelSelectResult result;
+  uint32_t expected[IPC_CHANNEL_SELECT_MAX];
+  bool parked = false;
+  bool polling = false;
+  bool expired = false;
+  uint32_t rounds = 0;
+  uint64_t nap_ns = SELECT_MIN_NAP_NS;
+  for (;;) {
+    uint64_t mask = 0;
+    size_t ready = 0;
+    IpcStatus failed = IPC_OK;
+    const char *failed_detail = NULL;
+    for (size_t i = 0; i < count && failed == IPC_OK; i++) {
+      expected[i] = atomic_load(words[i]);
+      IpcEntry entry;
+      const IpcBufferPeekResult peek_result =
+          ipc_buffer_peek(channels[i]->buffer, &entry);
+      if (peek_result.ipc_status == IPC_OK) {
+        mask |= 1ULL << i;
+        ready++;
+      } else if (!_is_retry_status(peek_result.ipc_status)) {
+        error.index = i;
+        failed = peek_result.ipc_status;
+        failed_detail = peek_result.error.detail;
+      }
+    }
+
+    if (failed != IPC_OK) {
+      result = IpcChannelSelectResult_error_body(failed, failed_detail, error);
+      break;
+    }
+
+    if (ready > 0) {
+      *ready_mask = mask;
+      result = IpcChannelSelectResult_ok(IPC_OK, ready);
+      break;
+    }
+
+    // the check after the sleep that hit the deadline was the last one
+    if (expired) {
+      *ready_mask = 0;
+      result = IpcChannelSelectResult_error_body(
+          IPC_ERR_TIMEOUT, "timeout: select timed out", error);
+      break;
+    }
+
+    if (!parked) {
+      for (size_t i = 0; i < count; i++) {
+        atomic_fetch_add(&channels[i]->header->notify_watchers, 1);
+      }
+      atomic_thread_fence(memory_order_seq_cst);
+      parked = true;
+      continue;
+    }
+
+    uint64_t now_ns = 0;
+    if (polling || rounds % DEADLINE_CHECK_ROUNDS == 0) {
+      struct timespec curr_time;
+      if (clock_gettime(CLOCK_MONOTONIC, &curr_time) != 0) {
+        error.sys_errno = errno;
+        result = IpcChannelSelectResult_error_body(
+            IPC_ERR_SYSTEM, "system error: clock_gettime failed", error);
+        break;
+      }
+
+      now_ns = ipc_timespec_to_nanos(&curr_time);
+      if (now_ns >= deadline_ns) {
+        *ready_mask = 0;
+        result = IpcChannelSelectResult_error_body(
+            IPC_ERR_TIMEOUT, "timeout: select timed out", error);
+        break;
+      }
+    }
+
+    if (rounds < UINT32_MAX) {
+      rounds++;
+    }
+
+    if (!polling) {
+      const int wait_res =
+          ipc_futex_waitv(words, expected, (uint32_t)count, &deadline);
+      if (wait_res == ETIMEDOUT) {
+        expired = true;
+      } else if (wait_res == ENOSYS) {
+        // naps from the next round on, against the clock
+        polling = true;
+      } else if (wait_res != 0) {
+        error.sys_errno = wait_res;
+        result = IpcChannelSelectResult_error_body(
+            IPC_ERR_SYSTEM, "system error: futex_waitv failed", error);
+        break;
+      }
+    } else {
+      const uint64_t remaining_ns = deadline_ns - now_ns;
+      const uint64_t sleep_ns = nap_ns < remaining_ns ? nap_ns : remaining_ns;
+      const struct timespec nap = {.tv_sec = sleep_ns / NANOS_PER_SEC,
+                                   .tv_nsec = sleep_ns % NANOS_PER_SEC};
+      nanosleep(&nap, NULL);
+      nap_ns = nap_ns * WAIT_EXPAND_FACTOR < SELECT_MAX_NAP_NS
+                   ? nap_ns * WAIT_EXPAND_FACTOR
+                   : SELECT_MAX_NAP_NS;
+    }
+  }
+
+  if (parked) {
+    for (size_t i = 0; i < count; i++) {
+      atomic_fetch_sub(&channels[i]->header->notify_watchers, 1);
+    }
+  }
+
+  return result;
 }
+
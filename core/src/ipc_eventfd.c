@@ -0,0 +1,82 @@
+// syscall() is not part of POSIX, unistd.h declares it only with this
+#define _DEFAULT_SOURCE
+#include "ipc_eventfd.h"
+#include <errno.h>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+int ipc_eventfd_open(void) { return eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC); }
+
+int ipc_eventfd_import(int32_t pid, int32_t fd) {
+#if defined(SYS_pidfd_open) && defined(SYS_pidfd_getfd)
+  int copy = -1;
+  const int pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+  if (pidfd >= 0) {
+    copy = (int)syscall(SYS_pidfd_getfd, pidfd, fd, 0);
+    const int copy_errno = errno;
+    close(pidfd);
+    errno = copy_errno;
+  }
+  if (copy >= 0 || errno != ENOSYS || pid != getpid()) {
+    return copy;
+  }
+#else
+  if (pid != getpid()) {
+    errno = ENOSYS;
+    return -1;
+  }
+#endif
+  // no pidfd support, still fine inside the owner's process
+  return dup(fd);
+}
+
+int ipc_eventfd_signal(int fd) {
+  const uint64_t one = 1;
+  // EAGAIN: the counter is saturated, the descriptor is readable anyway
+  if (write(fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+    return -1;
+  }
+
+  return 0;
+}
+
+int ipc_eventfd_clear(int fd) {
+  uint64_t count;
+  // EAGAIN: nothing was signalled
+  if (read(fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+    return -1;
+  }
+
+  return 0;
+}
+
+#else
+
+int ipc_eventfd_open(void) {
+  errno = ENOSYS;
+  return -1;
+}
+
+int ipc_eventfd_import(int32_t pid, int32_t fd) {
+  (void)pid;
+  (void)fd;
+  errno = ENOSYS;
+  return -1;
+}
+
+int ipc_eventfd_signal(int fd) {
+  (void)fd;
+  errno = ENOSYS;
+  return -1;
+}
+
+int ipc_eventfd_clear(int fd) {
+  (void)fd;
+  errno = ENOSYS;
+  return -1;
+}
+
+#endif
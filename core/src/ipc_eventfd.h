@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+
+// All return -1 with errno set on failure, ENOSYS where eventfd does not
+// exist.
+int ipc_eventfd_open(void);
+// Copy of descriptor fd of process pid in this process (pidfd_getfd), needs
+// ptrace access to pid.
+int ipc_eventfd_import(int32_t pid, int32_t fd);
+int ipc_eventfd_signal(int fd);
+// Resets the counter, the descriptor stops polling readable.
+int ipc_eventfd_clear(int fd);
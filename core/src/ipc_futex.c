@@ -29,6 +29,26 @@ int ipc_futex_wait(_Atomic uint32_t *addr, uint32_t expected,
   return res;
 }
 
+// __ulock_wait only knows relative timeouts in microseconds, 0 is forever
+int ipc_futex_wait_until(_Atomic uint32_t *addr, uint32_t expected,
+                         const struct timespec *deadline) {
+  struct timespec now;
+  if (clock_gettime(CLOCK_MONOTONIC, &now) != 0) {
+    return errno;
+  }
+
+  const int64_t remaining_us =
+      (deadline->tv_sec - now.tv_sec) * 1000000 +
+      (deadline->tv_nsec - now.tv_nsec) / 1000;
+  if (remaining_us <= 0) {
+    return ETIMEDOUT;
+  }
+
+  const struct timespec timeout = {.tv_sec = remaining_us / 1000000,
+                                   .tv_nsec = (remaining_us % 1000000) * 1000};
+  return ipc_futex_wait(addr, expected, &timeout);
+}
+
 int ipc_futex_wake_one(_Atomic uint32_t *addr) {
   int res = __ulock_wake(UL_COMPARE_AND_WAIT, addr, 0);
   if (res != 0 && errno == ENOENT) {
@@ -38,6 +58,18 @@ int ipc_futex_wake_one(_Atomic uint32_t *addr) {
   return res;
 }
 
+// __ulock_wake has no count, wake one at a time until nobody is left
+int ipc_futex_wake_n(_Atomic uint32_t *addr, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    const int res = __ulock_wake(UL_COMPARE_AND_WAIT, addr, 0);
+    if (res != 0) {
+      return errno == ENOENT ? 0 : res;
+    }
+  }
+
+  return 0;
+}
+
 int ipc_futex_wake_all(_Atomic uint32_t *addr) {
   int res = __ulock_wake(UL_COMPARE_AND_WAIT | ULF_WAKE_ALL, addr, 0);
   if (res != 0 && errno == ENOENT) {
@@ -47,6 +79,15 @@ int ipc_futex_wake_all(_Atomic uint32_t *addr) {
   return res;
 }
 
+int ipc_futex_waitv(_Atomic uint32_t *const *addrs, const uint32_t *expected,
+                    uint32_t count, const struct timespec *deadline) {
+  (void)addrs;
+  (void)expected;
+  (void)count;
+  (void)deadline;
+  return ENOSYS;
+}
+
 #elif defined(__linux__)
 #include <limits.h>
 #include <linux/futex.h>
@@ -72,11 +113,72 @@ int ipc_futex_wait(_Atomic uint32_t *addr, uint32_t expected,
   return res;
 }
 
+int ipc_futex_wait_until(_Atomic uint32_t *addr, uint32_t expected,
+                         const struct timespec *deadline) {
+  // FUTEX_WAIT_BITSET takes the timeout as an absolute CLOCK_MONOTONIC time,
+  // FUTEX_WAIT as a relative one
+  int res = syscall(SYS_futex, addr, FUTEX_WAIT_BITSET, expected, deadline,
+                    NULL, FUTEX_BITSET_MATCH_ANY);
+  if (res != 0) {
+    // EAGAIN/EINTR: continue the loop, like ipc_futex_wait
+    if (errno == EAGAIN || errno == EINTR) {
+      return 0;
+    }
+
+    return errno;
+  }
+
+  return res;
+}
+
 int ipc_futex_wake_one(_Atomic uint32_t *addr) {
   return syscall(SYS_futex, addr, FUTEX_WAKE, 1);
 }
 
+int ipc_futex_wake_n(_Atomic uint32_t *addr, uint32_t count) {
+  return syscall(SYS_futex, addr, FUTEX_WAKE,
+                 count > INT_MAX ? INT_MAX : (int)count);
+}
+
 int ipc_futex_wake_all(_Atomic uint32_t *addr) {
   return syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX);
 }
+
+int ipc_futex_waitv(_Atomic uint32_t *const *addrs, const uint32_t *expected,
+                    uint32_t count, const struct timespec *deadline) {
+#if defined(SYS_futex_waitv) && defined(FUTEX_WAITV_MAX)
+  if (count > FUTEX_WAITV_MAX) {
+    return EINVAL;
+  }
+
+  struct futex_waitv waiters[FUTEX_WAITV_MAX];
+  for (uint32_t i = 0; i < count; i++) {
+    waiters[i] = (struct futex_waitv){.val = expected[i],
+                                      .uaddr = (uintptr_t)addrs[i],
+                                      .flags = FUTEX_32,
+                                      .__reserved = 0};
+  }
+
+  // glibc has no wrapper, the kernel takes a 64-bit timespec
+  // (struct __kernel_timespec)
+  struct {
+    int64_t tv_sec;
+    long long tv_nsec;
+  } abs_deadline = {.tv_sec = deadline->tv_sec, .tv_nsec = deadline->tv_nsec};
+  const long res = syscall(SYS_futex_waitv, waiters, count, 0, &abs_deadline,
+                           CLOCK_MONOTONIC);
+  // EAGAIN: one of the values changed before we slept, like ipc_futex_wait
+  if (res < 0 && errno != EAGAIN && errno != EINTR) {
+    return errno;
+  }
+
+  return 0;
+#else
+  (void)addrs;
+  (void)expected;
+  (void)count;
+  (void)deadline;
+  return ENOSYS;
+#endif
+}
 #endif
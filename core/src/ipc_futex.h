@@ -6,5 +6,17 @@
 
 int ipc_futex_wait(_Atomic uint32_t *addr, uint32_t expected,
                    const struct timespec *timeout);
+// Like ipc_futex_wait, but until an absolute CLOCK_MONOTONIC deadline, so a
+// retry loop can pass the same one again without reading the clock. Returns
+// ETIMEDOUT once it has passed.
+int ipc_futex_wait_until(_Atomic uint32_t *addr, uint32_t expected,
+                         const struct timespec *deadline);
 int ipc_futex_wake_one(_Atomic uint32_t *addr);
+// wakes at most count waiters
+int ipc_futex_wake_n(_Atomic uint32_t *addr, uint32_t count);
 int ipc_futex_wake_all(_Atomic uint32_t *addr);
+// Sleeps until one of addrs[i] no longer holds expected[i], it is woken or the
+// absolute CLOCK_MONOTONIC deadline passes (ETIMEDOUT). ENOSYS without
+// futex_waitv (Linux < 5.16, other platforms).
+int ipc_futex_waitv(_Atomic uint32_t *const *addrs, const uint32_t *expected,
+                    uint32_t count, const struct timespec *deadline);
@@ -21,6 +21,13 @@ static uint64_t _find_next_power_of_2(uint64_t n);
 static ValidationResult _validate_size(size_t requested_size, uint64_t min_size,
                                        uint64_t overhead);
 
+static uint64_t _channel_overhead(const IpcBufferOptions *options);
+
+static IpcMemorySegmentResult _map_channel(const char *path, const size_t size,
+                                           const IpcBufferOptions *options);
+
+static bool _is_mirrored(const IpcBufferOptions *options);
+
 uint64_t ipc_init_suggest_buffer_size(size_t desired_capacity) {
   const uint64_t min_size = ipc_buffer_get_min_size();
   const uint64_t overhead = ipc_buffer_get_memory_overhead();
@@ -67,7 +74,7 @@ IpcInitBufferCreateResult ipc_init_buffer_create(const char *path,
   }
 
   const IpcBufferCreateResult buffer_result =
-      ipc_buffer_create(mmap.result, size);
+      ipc_buffer_create(mmap.result->memory, size);
   if (IpcBufferCreateResult_is_error(buffer_result)) {
     error.sys_errno = buffer_result.error.body.sys_errno;
     return IpcInitBufferCreateResult_error_body(
@@ -98,7 +105,8 @@ IpcInitBufferAttachResult ipc_init_buffer_attach(const char *path,
                                                 mmap.error.detail, error);
   }
 
-  const IpcBufferAttachResult buffer_result = ipc_buffer_attach(mmap.result);
+  const IpcBufferAttachResult buffer_result =
+      ipc_buffer_attach(mmap.result->memory);
   if (IpcBufferAttachResult_is_error(buffer_result)) {
     return IpcInitBufferAttachResult_error_body(
         buffer_result.ipc_status, buffer_result.error.detail, error);
@@ -109,10 +117,20 @@ IpcInitBufferAttachResult ipc_init_buffer_attach(const char *path,
 
 IpcInitChannelOpenResult ipc_init_channel_create(const char *path,
                                                  const size_t size) {
+  const IpcBufferOptions options = {.flags = 0};
+  return ipc_init_channel_create_with_options(path, size, &options);
+}
+
+IpcInitChannelOpenResult
+ipc_init_channel_create_with_options(const char *path, const size_t size,
+                                     const IpcBufferOptions *options) {
   IpcInitChannelOpenError error = {.requested_size = size};
 
-  const ValidationResult validation = _validate_size(
-      size, ipc_channel_get_min_size(), ipc_channel_get_memory_overhead());
+  const uint64_t overhead = _channel_overhead(options);
+  const ValidationResult validation =
+      _validate_size(size, overhead + ipc_channel_get_min_size() -
+                               ipc_channel_get_memory_overhead(),
+                     overhead);
 
   if (validation.status != IPC_OK) {
     error.min_size = validation.min_size;
@@ -121,7 +139,7 @@ IpcInitChannelOpenResult ipc_init_channel_create(const char *path,
                                                validation.error_msg, error);
   }
 
-  const IpcMemorySegmentResult mmap = ipc_mmap(path, size);
+  const IpcMemorySegmentResult mmap = _map_channel(path, size, options);
   if (IpcMemorySegmentResult_is_error(mmap)) {
     error.sys_errno = mmap.error.body.sys_errno;
     return IpcInitChannelOpenResult_error_body(mmap.ipc_status,
@@ -129,7 +147,7 @@ IpcInitChannelOpenResult ipc_init_channel_create(const char *path,
   }
 
   const IpcChannelOpenResult channel_open_result =
-      ipc_channel_create(mmap.result, size);
+      ipc_channel_create_with_options(mmap.result->memory, size, options);
   if (IpcChannelOpenResult_is_error(channel_open_result)) {
     error.sys_errno = channel_open_result.error.body.sys_errno;
     return IpcInitChannelOpenResult_error_body(channel_open_result.ipc_status,
@@ -142,10 +160,19 @@ IpcInitChannelOpenResult ipc_init_channel_create(const char *path,
 
 IpcInitChannelConnectResult ipc_init_channel_connect(const char *path,
                                                      const size_t size) {
+  return ipc_init_channel_connect_with_options(path, size, NULL);
+}
+
+IpcInitChannelConnectResult
+ipc_init_channel_connect_with_options(const char *path, const size_t size,
+                                      const IpcBufferOptions *options) {
   IpcInitChannelConnectError error = {.requested_size = size};
 
-  const ValidationResult validation = _validate_size(
-      size, ipc_channel_get_min_size(), ipc_channel_get_memory_overhead());
+  const uint64_t overhead = _channel_overhead(options);
+  const ValidationResult validation =
+      _validate_size(size, overhead + ipc_channel_get_min_size() -
+                               ipc_channel_get_memory_overhead(),
+                     overhead);
 
   if (validation.status != IPC_OK) {
     error.min_size = validation.min_size;
@@ -154,7 +181,7 @@ IpcInitChannelConnectResult ipc_init_channel_connect(const char *path,
                                                   validation.error_msg, error);
   }
 
-  const IpcMemorySegmentResult mmap = ipc_mmap(path, size);
+  const IpcMemorySegmentResult mmap = _map_channel(path, size, options);
   if (IpcMemorySegmentResult_is_error(mmap)) {
     error.sys_errno = mmap.error.body.sys_errno;
     return IpcInitChannelConnectResult_error_body(mmap.ipc_status,
@@ -162,7 +189,9 @@ IpcInitChannelConnectResult ipc_init_channel_connect(const char *path,
   }
 
   const IpcChannelConnectResult channel_connect_result =
-      ipc_channel_connect(mmap.result);
+      options == NULL
+          ? ipc_channel_connect(mmap.result->memory)
+          : ipc_channel_connect_with_options(mmap.result->memory, options);
 
   if (IpcChannelConnectResult_is_error(channel_connect_result)) {
     return IpcInitChannelConnectResult_error_body(
@@ -170,6 +199,18 @@ IpcInitChannelConnectResult ipc_init_channel_connect(const char *path,
         error);
   }
 
+  // NULL options accept any mode, but entries of a mirrored ring run across
+  // the wrap point and past the end of a single mapping
+  if ((ipc_channel_get_flags(channel_connect_result.result) &
+       IPC_BUFFER_MIRRORED) != 0 &&
+      !_is_mirrored(options)) {
+    ipc_channel_destroy(channel_connect_result.result);
+    ipc_unmap(mmap.result);
+    return IpcInitChannelConnectResult_error_body(
+        IPC_ERR_ILLEGAL_STATE,
+        "illegal state: channel is mirrored, connect with its options", error);
+  }
+
   return IpcInitChannelConnectResult_ok(IPC_OK, channel_connect_result.result);
 }
 
@@ -208,3 +249,24 @@ static ValidationResult _validate_size(size_t requested_size, uint64_t min_size,
   result.status = IPC_OK;
   return result;
 }
+
+static IpcMemorySegmentResult _map_channel(const char *path, const size_t size,
+                                           const IpcBufferOptions *options) {
+  if (!_is_mirrored(options)) {
+    return ipc_mmap(path, size);
+  }
+
+  const uint64_t overhead = _channel_overhead(options);
+  return ipc_mmap_mirrored(path, overhead, size - overhead);
+}
+
+static inline bool _is_mirrored(const IpcBufferOptions *options) {
+  return options != NULL && (options->flags & IPC_BUFFER_MIRRORED) != 0;
+}
+
+// channel header plus the buffer header, and cursor slots of a broadcast
+// buffer
+static uint64_t _channel_overhead(const IpcBufferOptions *options) {
+  return ipc_channel_get_memory_overhead() - ipc_buffer_get_memory_overhead() +
+         ipc_buffer_get_memory_overhead_with_options(options);
+}
@@ -1,3 +1,4 @@
+#include "ipc_utils.h"
 #include <errno.h>
 #include <fcntl.h>
 #include <shmipc/ipc_mmap.h>
@@ -150,6 +151,84 @@ SHMIPC_API IpcMemorySegmentResult ipc_mmap(const char *path,
   segment->name = name_copy;
   segment->memory = mapped;
   segment->size = actual_size;
+  segment->mapping = mapped;
+  segment->mapping_size = actual_size;
+
+  return IpcMemorySegmentResult_ok(IPC_OK, segment);
+}
+
+SHMIPC_API IpcMemorySegmentResult ipc_mmap_mirrored(const char *path,
+                                                    const uint64_t header_size,
+                                                    const uint64_t data_size) {
+  IpcMmapError error = {.name = NULL,
+                        .requested_size = header_size + data_size,
+                        .existing_size = 0,
+                        .existed = false,
+                        .sys_errno = 0};
+
+  if (path == NULL) {
+    return IpcMemorySegmentResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: path is NULL", error);
+  }
+
+  const uint64_t page_size = (uint64_t)sysconf(_SC_PAGESIZE);
+  if (data_size == 0 || data_size % page_size != 0) {
+    return IpcMemorySegmentResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT,
+        "invalid argument: data size must be a multiple of the page size",
+        error);
+  }
+
+  // the data starts on a page boundary, the header sits right in front of it
+  const uint64_t data_offset = ALIGN_UP(header_size, page_size);
+  const uint64_t file_size = data_offset + data_size;
+  const uint64_t mapping_size = file_size + data_size;
+
+  const IpcMemorySegmentResult result = ipc_mmap(path, file_size);
+  if (IpcMemorySegmentResult_is_error(result)) {
+    return result;
+  }
+  IpcMemorySegment *segment = result.result;
+  error.name = path;
+
+  const int fd = shm_open(path, O_RDWR, OPEN_MODE);
+  if (fd < 0) {
+    error.sys_errno = errno;
+    ipc_unmap(segment);
+    return IpcMemorySegmentResult_error_body(
+        IPC_ERR_SYSTEM, "system error: shm_open (open) failed", error);
+  }
+
+  // reserve the whole range first so that both views land back to back,
+  // pages past the end of the file are never touched through it
+  uint8_t *base = (uint8_t *)mmap(NULL, (size_t)mapping_size, PROT_NONE,
+                                  MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    error.sys_errno = errno;
+    close(fd);
+    ipc_unmap(segment);
+    return IpcMemorySegmentResult_error_body(
+        IPC_ERR_SYSTEM, "system error: mmap failed", error);
+  }
+
+  if (mmap(base, (size_t)file_size, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+      mmap(base + file_size, (size_t)data_size, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_FIXED, fd, (off_t)data_offset) == MAP_FAILED) {
+    error.sys_errno = errno;
+    munmap(base, (size_t)mapping_size);
+    close(fd);
+    ipc_unmap(segment);
+    return IpcMemorySegmentResult_error_body(
+        IPC_ERR_SYSTEM, "system error: mirror mmap failed", error);
+  }
+  close(fd);
+
+  munmap(segment->mapping, (size_t)segment->mapping_size);
+  segment->mapping = base;
+  segment->mapping_size = mapping_size;
+  segment->memory = base + data_offset - header_size;
+  segment->size = header_size + data_size;
 
   return IpcMemorySegmentResult_ok(IPC_OK, segment);
 }
@@ -167,7 +246,7 @@ SHMIPC_API IpcMmapUnmapResult ipc_unmap(IpcMemorySegment *segment) {
   }
 
   errno = 0;
-  if (munmap(segment->memory, (size_t)segment->size) != 0) {
+  if (munmap(segment->mapping, (size_t)segment->mapping_size) != 0) {
     IpcMmapUnmapError body = {
         .name = segment->name, .size = segment->size, .sys_errno = errno};
     return IpcMmapUnmapResult_error_body(IPC_ERR_SYSTEM,
@@ -0,0 +1,223 @@
+#include "ipc_payload_pool.h"
+#include "ipc_utils.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// 64 bytes to 64 KiB, larger payloads bypass the pool
+#define POOL_MIN_CLASS_SHIFT 6
+#define POOL_CLASSES 11
+#define POOL_UNPOOLED UINT32_MAX
+
+typedef struct Block {
+  // NULL when the payload is too large for any class
+  struct IpcPayloadPool *pool;
+  // next cached block of the class, only while cached
+  struct Block *next;
+  uint32_t size_class;
+  alignas(max_align_t) uint8_t payload[];
+} Block;
+
+// Blocks of one class, a plain stack behind a spinlock: the critical section
+// is two pointer moves, and blocks freed on another thread than the reader go
+// straight back to where the reader looks for them.
+typedef struct FreeList {
+  _Atomic bool lock;
+  uint32_t count;
+  Block *top;
+  // counted under the lock, it is taken anyway
+  uint64_t hits;
+  uint64_t misses;
+} FreeList;
+
+struct IpcPayloadPool {
+  FreeList classes[POOL_CLASSES];
+  size_t max_cached;
+  // the creator's plus one per block in existence, cached or handed out, so
+  // recycling a block touches no shared counter besides the class lock
+  _Atomic uint64_t refs;
+  // set by ipc_payload_pool_destroy, released blocks are freed from then on
+  _Atomic bool closed;
+  // misses of payloads too large for any class
+  _Atomic uint64_t oversized;
+};
+
+static uint32_t _size_class(const size_t);
+static size_t _class_size(const uint32_t);
+static void _lock(FreeList *);
+static void _unlock(FreeList *);
+static void _drain(IpcPayloadPool *);
+static void _put(IpcPayloadPool *);
+
+IpcPayloadPool *ipc_payload_pool_create(const size_t max_cached) {
+  IpcPayloadPool *pool = (IpcPayloadPool *)malloc(sizeof(IpcPayloadPool));
+  if (pool == NULL) {
+    return NULL;
+  }
+
+  for (uint32_t i = 0; i < POOL_CLASSES; i++) {
+    atomic_init(&pool->classes[i].lock, false);
+    pool->classes[i].count = 0;
+    pool->classes[i].top = NULL;
+    pool->classes[i].hits = 0;
+    pool->classes[i].misses = 0;
+  }
+  pool->max_cached = max_cached;
+  atomic_init(&pool->refs, 1);
+  atomic_init(&pool->closed, false);
+  atomic_init(&pool->oversized, 0);
+
+  return pool;
+}
+
+void ipc_payload_pool_destroy(IpcPayloadPool *pool) {
+  if (pool == NULL) {
+    return;
+  }
+
+  // ordered before the drain by the class locks: a release either sees it
+  // or caches its block before the drain takes it
+  atomic_store_explicit(&pool->closed, true, memory_order_relaxed);
+  _drain(pool);
+  _put(pool);
+}
+
+void *ipc_payload_pool_alloc(IpcPayloadPool *pool, const size_t size,
+                             size_t *capacity) {
+  const uint32_t size_class = _size_class(size);
+  if (size_class == POOL_UNPOOLED) {
+    atomic_fetch_add_explicit(&pool->oversized, 1, memory_order_relaxed);
+    Block *block = (Block *)malloc(sizeof(Block) + size);
+    if (block == NULL) {
+      return NULL;
+    }
+
+    block->pool = NULL;
+    block->size_class = POOL_UNPOOLED;
+    *capacity = size;
+    return block->payload;
+  }
+
+  FreeList *list = &pool->classes[size_class];
+  _lock(list);
+  Block *block = list->top;
+  if (block != NULL) {
+    list->top = block->next;
+    list->count--;
+    list->hits++;
+  } else {
+    list->misses++;
+  }
+  _unlock(list);
+
+  if (block == NULL) {
+    block = (Block *)malloc(sizeof(Block) + _class_size(size_class));
+    if (block == NULL) {
+      return NULL;
+    }
+
+    block->pool = pool;
+    block->size_class = size_class;
+    atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
+  }
+
+  *capacity = _class_size(size_class);
+  return block->payload;
+}
+
+void ipc_payload_pool_release(void *payload) {
+  if (payload == NULL) {
+    return;
+  }
+
+  Block *block = (Block *)((uint8_t *)payload - offsetof(Block, payload));
+  IpcPayloadPool *pool = block->pool;
+  if (pool == NULL) {
+    free(block);
+    return;
+  }
+
+  FreeList *list = &pool->classes[block->size_class];
+  bool cached = false;
+  _lock(list);
+  if (list->count < pool->max_cached &&
+      !atomic_load_explicit(&pool->closed, memory_order_relaxed)) {
+    block->next = list->top;
+    list->top = block;
+    list->count++;
+    cached = true;
+  }
+  _unlock(list);
+
+  if (!cached) {
+    free(block);
+    _put(pool);
+  }
+}
+
+void ipc_payload_pool_stats(IpcPayloadPool *pool, uint64_t *hits,
+                            uint64_t *misses) {
+  *hits = 0;
+  *misses = atomic_load_explicit(&pool->oversized, memory_order_relaxed);
+  for (uint32_t i = 0; i < POOL_CLASSES; i++) {
+    FreeList *list = &pool->classes[i];
+    _lock(list);
+    *hits += list->hits;
+    *misses += list->misses;
+    _unlock(list);
+  }
+}
+
+static inline uint32_t _size_class(const size_t size) {
+  uint32_t size_class = 0;
+  while (_class_size(size_class) < size) {
+    if (++size_class == POOL_CLASSES) {
+      return POOL_UNPOOLED;
+    }
+  }
+
+  return size_class;
+}
+
+static inline size_t _class_size(const uint32_t size_class) {
+  return (size_t)1 << (POOL_MIN_CLASS_SHIFT + size_class);
+}
+
+static inline void _lock(FreeList *list) {
+  bool unlocked = false;
+  while (!atomic_compare_exchange_weak_explicit(&list->lock, &unlocked, true,
+                                                memory_order_acquire,
+                                                memory_order_relaxed)) {
+    unlocked = false;
+    ipc_cpu_relax();
+  }
+}
+
+static inline void _unlock(FreeList *list) {
+  atomic_store_explicit(&list->lock, false, memory_order_release);
+}
+
+static void _drain(IpcPayloadPool *pool) {
+  for (uint32_t i = 0; i < POOL_CLASSES; i++) {
+    FreeList *list = &pool->classes[i];
+    _lock(list);
+    Block *block = list->top;
+    list->top = NULL;
+    list->count = 0;
+    _unlock(list);
+
+    while (block != NULL) {
+      Block *next = block->next;
+      free(block);
+      _put(pool);
+      block = next;
+    }
+  }
+}
+
+static void _put(IpcPayloadPool *pool) {
+  if (atomic_fetch_sub_explicit(&pool->refs, 1, memory_order_acq_rel) == 1) {
+    free(pool);
+  }
+}
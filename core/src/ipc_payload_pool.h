@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Recycles read payloads in power of 2 size classes. Every block starts with a
+// small header that points back at its pool, so a payload can be released
+// without knowing where it came from.
+typedef struct IpcPayloadPool IpcPayloadPool;
+
+// NULL with errno set when the allocation fails
+IpcPayloadPool *ipc_payload_pool_create(size_t max_cached);
+// Drops the creator's reference: cached blocks are freed, the pool itself
+// once the last block handed out is released.
+void ipc_payload_pool_destroy(IpcPayloadPool *pool);
+
+// A payload of at least size bytes, capacity receives its usable size. NULL
+// with errno set when the allocation fails.
+void *ipc_payload_pool_alloc(IpcPayloadPool *pool, size_t size,
+                             size_t *capacity);
+// Frees, or caches in its pool, a payload of ipc_payload_pool_alloc.
+void ipc_payload_pool_release(void *payload);
+
+void ipc_payload_pool_stats(IpcPayloadPool *pool, uint64_t *hits,
+                            uint64_t *misses);
@@ -0,0 +1,264 @@
+#include "ipc_utils.h"
+#include <errno.h>
+#include <shmipc/ipc_common.h>
+#include <shmipc/ipc_ring.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define IPC_DATA_ALIGN 0x8
+
+#define RING_HEADER_SIZE_ALIGNED sizeof(IpcRingHeader)
+
+typedef struct IpcRingHeader {
+  _Atomic uint64_t capacity;
+  uint64_t slot_size;
+  uint8_t _c_padding[64 - 2 * sizeof(uint64_t)];
+
+  _Atomic uint64_t tail;
+  uint8_t _w_padding[64 - sizeof(uint64_t)];
+
+  _Atomic uint64_t head;
+  uint8_t _r_padding[64 - sizeof(uint64_t)];
+} IpcRingHeader;
+
+// seq == pos: free for the producer of pos
+// seq == pos + 1: holds the entry of pos
+// seq == pos + capacity: consumed, free for the producer of the next lap
+typedef struct SlotHeader {
+  _Atomic uint64_t seq;
+  uint64_t size;
+} SlotHeader;
+
+struct IpcRing {
+  IpcRingHeader *header;
+  uint8_t *slots;
+  uint64_t capacity;
+  uint64_t slot_size;
+  uint64_t stride;
+};
+
+static uint64_t _stride(const uint64_t slot_size);
+static SlotHeader *_slot_at(const struct IpcRing *ring, const uint64_t pos);
+
+inline uint64_t ipc_ring_get_memory_overhead(void) {
+  return RING_HEADER_SIZE_ALIGNED;
+}
+
+uint64_t ipc_ring_suggest_size(size_t slot_size, size_t desired_capacity) {
+  const uint64_t capacity =
+      desired_capacity == 0 ? 1 : find_next_power_of_2(desired_capacity);
+  return RING_HEADER_SIZE_ALIGNED + capacity * _stride(slot_size);
+}
+
+IpcRingCreateResult ipc_ring_create(void *mem, const size_t size,
+                                    const size_t slot_size) {
+  IpcRingCreateError error = {.requested_size = size,
+                              .min_size = RING_HEADER_SIZE_ALIGNED +
+                                          _stride(slot_size)};
+
+  if (mem == NULL) {
+    return IpcRingCreateResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: mem is NULL", error);
+  }
+
+  if (slot_size == 0) {
+    return IpcRingCreateResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: slot size is 0", error);
+  }
+
+  if (size < error.min_size) {
+    return IpcRingCreateResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: ring size too small",
+        error);
+  }
+
+  const uint64_t stride = _stride(slot_size);
+  uint64_t capacity = 1;
+  while (capacity * 2 <= (size - RING_HEADER_SIZE_ALIGNED) / stride) {
+    capacity *= 2;
+  }
+
+  struct IpcRing *ring = (struct IpcRing *)malloc(sizeof(struct IpcRing));
+  if (ring == NULL) {
+    error.sys_errno = errno;
+    return IpcRingCreateResult_error_body(
+        IPC_ERR_SYSTEM, "system error: ring allocation failed", error);
+  }
+
+  ring->header = (IpcRingHeader *)mem;
+  ring->slots = ((uint8_t *)mem) + RING_HEADER_SIZE_ALIGNED;
+  ring->capacity = capacity;
+  ring->slot_size = slot_size;
+  ring->stride = stride;
+
+  for (uint64_t i = 0; i < capacity; i++) {
+    atomic_init(&_slot_at(ring, i)->seq, i);
+  }
+
+  ring->header->slot_size = slot_size;
+  atomic_init(&ring->header->head, 0);
+  atomic_init(&ring->header->tail, 0);
+  // published last, attach treats a ring without capacity as not created
+  atomic_store_explicit(&ring->header->capacity, capacity,
+                        memory_order_release);
+
+  return IpcRingCreateResult_ok(IPC_OK, ring);
+}
+
+IpcRingAttachResult ipc_ring_attach(void *mem) {
+  IpcRingAttachError error = {.min_size = RING_HEADER_SIZE_ALIGNED};
+  if (mem == NULL) {
+    return IpcRingAttachResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: mem is NULL", error);
+  }
+
+  IpcRingHeader *header = (IpcRingHeader *)mem;
+  const uint64_t capacity =
+      atomic_load_explicit(&header->capacity, memory_order_acquire);
+  if (capacity == 0 || !is_power_of_2(capacity) || header->slot_size == 0) {
+    return IpcRingAttachResult_error_body(
+        IPC_ERR_ILLEGAL_STATE, "illegal state: ring is not initialized",
+        error);
+  }
+
+  struct IpcRing *ring = (struct IpcRing *)malloc(sizeof(struct IpcRing));
+  if (ring == NULL) {
+    error.sys_errno = errno;
+    return IpcRingAttachResult_error_body(
+        IPC_ERR_SYSTEM, "system error: allocation failed", error);
+  }
+
+  ring->header = header;
+  ring->slots = ((uint8_t *)mem) + RING_HEADER_SIZE_ALIGNED;
+  ring->capacity = capacity;
+  ring->slot_size = header->slot_size;
+  ring->stride = _stride(header->slot_size);
+
+  return IpcRingAttachResult_ok(IPC_OK, ring);
+}
+
+uint64_t ipc_ring_get_capacity(const IpcRing *ring) {
+  return ring == NULL ? 0 : ring->capacity;
+}
+
+uint64_t ipc_ring_get_slot_size(const IpcRing *ring) {
+  return ring == NULL ? 0 : ring->slot_size;
+}
+
+IpcRingWriteResult ipc_ring_write(IpcRing *ring, const void *data,
+                                  const size_t size) {
+  IpcRingWriteError error = {
+      .offset = 0, .requested_size = size, .slot_size = 0};
+  if (ring == NULL) {
+    return IpcRingWriteResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: ring is NULL", error);
+  }
+
+  if (data == NULL) {
+    return IpcRingWriteResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: data is NULL", error);
+  }
+
+  if (size == 0) {
+    return IpcRingWriteResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: data size is 0", error);
+  }
+
+  error.slot_size = ring->slot_size;
+  if (size > ring->slot_size) {
+    return IpcRingWriteResult_error_body(
+        IPC_ERR_ENTRY_TOO_LARGE, "invalid argument: entry size exceeds slot",
+        error);
+  }
+
+  SlotHeader *slot;
+  uint64_t pos =
+      atomic_load_explicit(&ring->header->tail, memory_order_relaxed);
+  for (;;) {
+    slot = _slot_at(ring, pos);
+    const uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    const int64_t diff = (int64_t)(seq - pos);
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&ring->header->tail, &pos,
+                                                pos + 1, memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // the slot still holds the entry of the previous lap
+      error.offset = pos;
+      return IpcRingWriteResult_error_body(IPC_ERR_NO_SPACE_CONTIGUOUS,
+                                           "ring is full", error);
+    } else {
+      pos = atomic_load_explicit(&ring->header->tail, memory_order_relaxed);
+    }
+  }
+
+  memcpy(((uint8_t *)slot) + sizeof(SlotHeader), data, size);
+  slot->size = size;
+  atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+
+  return IpcRingWriteResult_ok(IPC_OK);
+}
+
+IpcRingReadResult ipc_ring_read(IpcRing *ring, IpcEntry *dest) {
+  IpcRingReadError error = {.offset = 0, .required_size = 0};
+  if (ring == NULL) {
+    return IpcRingReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: ring is NULL", error);
+  }
+
+  if (dest == NULL) {
+    return IpcRingReadResult_error_body(
+        IPC_ERR_INVALID_ARGUMENT, "invalid argument: dest is NULL", error);
+  }
+
+  SlotHeader *slot;
+  uint64_t size;
+  uint64_t pos =
+      atomic_load_explicit(&ring->header->head, memory_order_relaxed);
+  for (;;) {
+    slot = _slot_at(ring, pos);
+    const uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    const int64_t diff = (int64_t)(seq - (pos + 1));
+    if (diff == 0) {
+      // checked before the claim, a claimed slot can not be handed back
+      size = slot->size;
+      if (dest->size < size) {
+        error.offset = pos;
+        error.required_size = size;
+        return IpcRingReadResult_error_body(
+            IPC_ERR_TOO_SMALL, "destination buffer is too small", error);
+      }
+
+      if (atomic_compare_exchange_weak_explicit(&ring->header->head, &pos,
+                                                pos + 1, memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return IpcRingReadResult_ok(IPC_EMPTY);
+    } else {
+      pos = atomic_load_explicit(&ring->header->head, memory_order_relaxed);
+    }
+  }
+
+  memcpy(dest->payload, ((uint8_t *)slot) + sizeof(SlotHeader), size);
+  dest->offset = pos;
+  dest->size = size;
+  atomic_store_explicit(&slot->seq, pos + ring->capacity, memory_order_release);
+
+  return IpcRingReadResult_ok(IPC_OK);
+}
+
+static inline uint64_t _stride(const uint64_t slot_size) {
+  return ALIGN_UP(sizeof(SlotHeader) + slot_size, IPC_DATA_ALIGN);
+}
+
+static inline SlotHeader *_slot_at(const struct IpcRing *ring,
+                                   const uint64_t pos) {
+  return (SlotHeader *)(ring->slots + RELATIVE(pos, ring->capacity) *
+                                          ring->stride);
+}
@@ -18,4 +18,13 @@ uint64_t find_next_power_of_2(uint64_t n);
 uint64_t ipc_timespec_to_nanos(const struct timespec *);
 bool is_power_of_2(const uint64_t size);
 
+// spin-wait hint, lets the sibling hyperthread run and saves power
+static inline void ipc_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
 SHMIPC_END_DECLS
@@ -4,6 +4,8 @@
 #include "shmipc/ipc_buffer.h"
 #include "test_utils.h"
 #include <cstring>
+#include <string>
+#include <vector>
 
 TEST_CASE("buffer create - too small size") {
   uint8_t mem[128];
@@ -12,7 +14,7 @@ TEST_CASE("buffer create - too small size") {
 }
 
 TEST_CASE("buffer suggest_size - valid size calculation") {
-  uint8_t mem[128];
+  uint8_t mem[256];
   const IpcBufferCreateResult buffer_result =
       ipc_buffer_create(mem, ipc_buffer_suggest_size(0));
   test_utils::CHECK_OK(buffer_result);
@@ -180,6 +182,53 @@ TEST_CASE("read error structure verification") {
   CHECK(null_dest_result.error.body.offset == 0);
 }
 
+TEST_CASE("read sized - destination sized after the claim") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
+  IpcEntry entry = {.offset = 0, .payload = nullptr, .size = 0};
+  struct Sizing {
+    uint8_t storage[64];
+    size_t requested;
+    size_t calls;
+  } sizing = {{0}, 0, 0};
+  const IpcPayloadSizer sizer = [](size_t size, void *ctx) -> void * {
+    Sizing *s = static_cast<Sizing *>(ctx);
+    s->requested = size;
+    s->calls++;
+    return size <= sizeof(s->storage) ? s->storage : nullptr;
+  };
+
+  test_utils::CHECK_ERROR(
+      ipc_buffer_read_sized(buffer.get(), &entry, nullptr, &sizing),
+      IPC_ERR_INVALID_ARGUMENT);
+
+  const IpcBufferReadResult empty =
+      ipc_buffer_read_sized(buffer.get(), &entry, sizer, &sizing);
+  CHECK(empty.ipc_status == IPC_EMPTY);
+  CHECK(sizing.calls == 0);
+
+  const int test_data = 42;
+  test_utils::write_data(buffer.get(), test_data);
+  test_utils::CHECK_OK(
+      ipc_buffer_read_sized(buffer.get(), &entry, sizer, &sizing));
+  CHECK(sizing.calls == 1);
+  CHECK(sizing.requested == sizeof(test_data));
+  CHECK(entry.payload == sizing.storage);
+  CHECK(entry.size == sizeof(test_data));
+  CHECK(*(int *)entry.payload == test_data);
+
+  // no destination leaves the entry in place
+  uint8_t large[100] = {7};
+  CHECK(ipc_buffer_write(buffer.get(), large, sizeof(large)).ipc_status ==
+        IPC_OK);
+  const IpcBufferReadResult failed =
+      ipc_buffer_read_sized(buffer.get(), &entry, sizer, &sizing);
+  test_utils::CHECK_ERROR(failed, IPC_ERR_SYSTEM);
+  CHECK(failed.error.body.required_size == sizeof(large));
+  IpcEntry peeked;
+  CHECK(ipc_buffer_peek(buffer.get(), &peeked).ipc_status == IPC_OK);
+  CHECK(peeked.size == sizeof(large));
+}
+
 TEST_CASE("peek with NULL buffer") {
   IpcEntry entry;
   const IpcBufferPeekResult peek_result = ipc_buffer_peek(nullptr, &entry);
@@ -702,6 +751,639 @@ TEST_CASE("read too small") {
         IPC_ERR_TOO_SMALL);
 }
 
+TEST_CASE("reserve with NULL slot") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
+  test_utils::CHECK_ERROR(ipc_buffer_reserve(buffer.get(), sizeof(int), nullptr),
+                          IPC_ERR_INVALID_ARGUMENT);
+}
+
+TEST_CASE("reserve too large entry") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
+  IpcSlot slot;
+  test_utils::CHECK_ERROR(
+      ipc_buffer_reserve(buffer.get(), test_utils::SMALL_BUFFER_SIZE, &slot),
+      IPC_ERR_ENTRY_TOO_LARGE);
+}
+
+TEST_CASE("reserve commit read") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
+
+  IpcSlot slot;
+  test_utils::CHECK_OK(ipc_buffer_reserve(buffer.get(), sizeof(int), &slot));
+  CHECK(slot.size == sizeof(int));
+
+  const int val = 42;
+  memcpy(slot.payload, &val, sizeof(val));
+
+  IpcEntry entry;
+  CHECK(ipc_buffer_peek(buffer.get(), &entry).ipc_status != IPC_OK);
+
+  test_utils::CHECK_OK(ipc_buffer_commit(buffer.get(), &slot));
+  CHECK(test_utils::read_data<int>(buffer.get()) == val);
+}
+
+TEST_CASE("reserve locks out other writers") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
+
+  IpcSlot slot;
+  test_utils::CHECK_OK(ipc_buffer_reserve(buffer.get(), sizeof(int), &slot));
+
+  const int val = 42;
+  test_utils::CHECK_ERROR(ipc_buffer_write(buffer.get(), &val, sizeof(val)),
+                          IPC_ERR_LOCKED);
+
+  memcpy(slot.payload, &val, sizeof(val));
+  test_utils::CHECK_OK(ipc_buffer_commit(buffer.get(), &slot));
+
+  const int val2 = 43;
+  test_utils::write_data(buffer.get(), val2);
+  CHECK(test_utils::read_data<int>(buffer.get()) == val);
+  CHECK(test_utils::read_data<int>(buffer.get()) == val2);
+}
+
+TEST_CASE("reserve abort") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
+
+  IpcSlot slot;
+  test_utils::CHECK_OK(ipc_buffer_reserve(buffer.get(), sizeof(int), &slot));
+  test_utils::CHECK_OK(ipc_buffer_abort(buffer.get(), &slot));
+
+  IpcEntry entry;
+  CHECK(ipc_buffer_peek(buffer.get(), &entry).ipc_status == IPC_EMPTY);
+
+  test_utils::CHECK_ERROR(ipc_buffer_commit(buffer.get(), &slot),
+                          IPC_ERR_ILLEGAL_STATE);
+  test_utils::CHECK_ERROR(ipc_buffer_abort(buffer.get(), &slot),
+                          IPC_ERR_ILLEGAL_STATE);
+
+  const int val = 42;
+  test_utils::write_data(buffer.get(), val);
+  CHECK(test_utils::read_data<int>(buffer.get()) == val);
+}
+
+TEST_CASE("reserve wraps contiguous payload") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
+
+  std::vector<uint8_t> data(100, 0xAB);
+  test_utils::write_data(buffer.get(), 1);
+  test_utils::CHECK_OK(ipc_buffer_write(buffer.get(), data.data(), data.size()));
+  CHECK(test_utils::read_data<int>(buffer.get()) == 1);
+
+  test_utils::EntryWrapper entry(data.size());
+  IpcEntry entry_ref = entry.get();
+  test_utils::CHECK_OK(ipc_buffer_read(buffer.get(), &entry_ref));
+  CHECK(memcmp(entry_ref.payload, data.data(), data.size()) == 0);
+
+  IpcSlot slot;
+  test_utils::CHECK_OK(ipc_buffer_reserve(buffer.get(), data.size(), &slot));
+  CHECK(slot.offset == test_utils::SMALL_BUFFER_SIZE);
+  memset(slot.payload, 0xCD, slot.size);
+  test_utils::CHECK_OK(ipc_buffer_commit(buffer.get(), &slot));
+
+  entry_ref = entry.get();
+  test_utils::CHECK_OK(ipc_buffer_read(buffer.get(), &entry_ref));
+  CHECK(entry_ref.offset == slot.offset);
+  std::vector<uint8_t> expected(data.size(), 0xCD);
+  CHECK(memcmp(entry_ref.payload, expected.data(), expected.size()) == 0);
+}
+
+TEST_CASE("writev gathers into one entry") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
+
+  char header[] = "HDR:";
+  char body[] = "payload";
+  struct iovec iov[] = {{header, 4}, {NULL, 0}, {body, sizeof(body)}};
+
+  test_utils::CHECK_ERROR(ipc_buffer_writev(buffer.get(), NULL, 1),
+                          IPC_ERR_INVALID_ARGUMENT);
+  test_utils::CHECK_ERROR(ipc_buffer_writev(buffer.get(), iov, 0),
+                          IPC_ERR_INVALID_ARGUMENT);
+  test_utils::CHECK_ERROR(ipc_buffer_writev(buffer.get(), &iov[1], 1),
+                          IPC_ERR_INVALID_ARGUMENT);
+
+  test_utils::CHECK_OK(ipc_buffer_writev(buffer.get(), iov, 3));
+
+  test_utils::EntryWrapper entry(64);
+  IpcEntry entry_ref = entry.get();
+  test_utils::CHECK_OK(ipc_buffer_read(buffer.get(), &entry_ref));
+  CHECK(entry_ref.size == 4 + sizeof(body));
+  CHECK(strcmp(static_cast<char *>(entry_ref.payload), "HDR:payload") == 0);
+}
+
+TEST_CASE("write batch invalid arguments") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
+
+  const int val = 1;
+  IpcMessage messages[] = {{&val, sizeof(val)}, {NULL, sizeof(val)}};
+  test_utils::CHECK_ERROR(ipc_buffer_write_batch(buffer.get(), NULL, 1),
+                          IPC_ERR_INVALID_ARGUMENT);
+  test_utils::CHECK_ERROR(ipc_buffer_write_batch(buffer.get(), messages, 0),
+                          IPC_ERR_INVALID_ARGUMENT);
+
+  const IpcBufferWriteBatchResult result =
+      ipc_buffer_write_batch(buffer.get(), messages, 2);
+  test_utils::CHECK_ERROR(result, IPC_ERR_INVALID_ARGUMENT);
+  CHECK(result.error.body.index == 1);
+
+  IpcEntry entry;
+  CHECK(ipc_buffer_peek(buffer.get(), &entry).ipc_status == IPC_EMPTY);
+}
+
+TEST_CASE("write batch read back in order") {
+  test_utils::BufferWrapper buffer(test_utils::LARGE_BUFFER_SIZE);
+
+  int values[16];
+  IpcMessage messages[16];
+  for (int i = 0; i < 16; i++) {
+    values[i] = i;
+    messages[i] = {&values[i], sizeof(int)};
+  }
+
+  const IpcBufferWriteBatchResult result =
+      ipc_buffer_write_batch(buffer.get(), messages, 16);
+  test_utils::CHECK_OK(result);
+  CHECK(result.result == 16);
+
+  for (int i = 0; i < 16; i++) {
+    CHECK(test_utils::read_data<int>(buffer.get()) == i);
+  }
+
+  IpcEntry entry;
+  CHECK(ipc_buffer_peek(buffer.get(), &entry).ipc_status == IPC_EMPTY);
+}
+
+TEST_CASE("write batch partial and wrap") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
+
+  std::vector<uint8_t> data(100, 0xAB);
+  test_utils::write_data(buffer.get(), 1);
+  test_utils::CHECK_OK(ipc_buffer_write(buffer.get(), data.data(), data.size()));
+  CHECK(test_utils::read_data<int>(buffer.get()) == 1);
+
+  test_utils::EntryWrapper entry(data.size());
+  IpcEntry entry_ref = entry.get();
+  test_utils::CHECK_OK(ipc_buffer_read(buffer.get(), &entry_ref));
+
+  // the first entry lands after the wrap, the second does not fit
+  std::vector<uint8_t> first(100, 0x01);
+  std::vector<uint8_t> second(100, 0x02);
+  IpcMessage messages[] = {{first.data(), first.size()},
+                           {second.data(), second.size()}};
+  const IpcBufferWriteBatchResult result =
+      ipc_buffer_write_batch(buffer.get(), messages, 2);
+  test_utils::CHECK_OK(result);
+  CHECK(result.result == 1);
+
+  test_utils::CHECK_ERROR(ipc_buffer_write_batch(buffer.get(), &messages[1], 1),
+                          IPC_ERR_NO_SPACE_CONTIGUOUS);
+
+  entry_ref = entry.get();
+  test_utils::CHECK_OK(ipc_buffer_read(buffer.get(), &entry_ref));
+  CHECK(entry_ref.offset == test_utils::SMALL_BUFFER_SIZE);
+  CHECK(memcmp(entry_ref.payload, first.data(), first.size()) == 0);
+}
+
+TEST_CASE("concurrent write - write batch") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_CONCURRENT_WRITE);
+
+  for (int round = 0; round < 8; round++) {
+    int values[3] = {round, round + 1, round + 2};
+    IpcMessage messages[] = {{&values[0], sizeof(int)},
+                             {&values[1], sizeof(int)},
+                             {&values[2], sizeof(int)}};
+    const IpcBufferWriteBatchResult result =
+        ipc_buffer_write_batch(buffer.get(), messages, 3);
+    test_utils::CHECK_OK(result);
+    CHECK(result.result == 3);
+
+    for (int i = 0; i < 3; i++) {
+      CHECK(test_utils::read_data<int>(buffer.get()) == round + i);
+    }
+  }
+}
+
+static void collect_ints(const IpcEntry *entry, void *ctx) {
+  CHECK(entry->size == sizeof(int));
+  static_cast<std::vector<int> *>(ctx)->push_back(
+      *static_cast<const int *>(entry->payload));
+}
+
+TEST_CASE("read batch") {
+  test_utils::BufferWrapper buffer(test_utils::LARGE_BUFFER_SIZE);
+  std::vector<int> values;
+
+  test_utils::CHECK_ERROR(
+      ipc_buffer_read_batch(buffer.get(), 0, collect_ints, &values),
+      IPC_ERR_INVALID_ARGUMENT);
+
+  IpcBufferReadBatchResult result =
+      ipc_buffer_read_batch(buffer.get(), 8, collect_ints, &values);
+  CHECK(result.ipc_status == IPC_EMPTY);
+  CHECK(result.result == 0);
+
+  for (int i = 0; i < 10; i++) {
+    test_utils::write_data(buffer.get(), i);
+  }
+
+  result = ipc_buffer_read_batch(buffer.get(), 8, collect_ints, &values);
+  test_utils::CHECK_OK(result);
+  CHECK(result.result == 8);
+
+  result = ipc_buffer_read_batch(buffer.get(), 8, collect_ints, &values);
+  test_utils::CHECK_OK(result);
+  CHECK(result.result == 2);
+
+  REQUIRE(values.size() == 10);
+  for (int i = 0; i < 10; i++) {
+    CHECK(values[i] == i);
+  }
+
+  IpcEntry entry;
+  CHECK(ipc_buffer_peek(buffer.get(), &entry).ipc_status == IPC_EMPTY);
+}
+
+TEST_CASE("read batch across wrap") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_CONCURRENT_WRITE);
+  std::vector<int> values;
+
+  int expected = 0;
+  for (int round = 0; round < 10; round++) {
+    for (int i = 0; i < 5; i++) {
+      test_utils::write_data(buffer.get(), expected + i);
+    }
+
+    const IpcBufferReadBatchResult result =
+        ipc_buffer_read_batch(buffer.get(), 16, collect_ints, &values);
+    test_utils::CHECK_OK(result);
+    CHECK(result.result == 5);
+    expected += 5;
+  }
+
+  REQUIRE(values.size() == 50);
+  for (int i = 0; i < 50; i++) {
+    CHECK(values[i] == i);
+  }
+}
+
+TEST_CASE("acquire release in place") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
+
+  IpcEntry entry;
+  CHECK(ipc_buffer_acquire(buffer.get(), &entry).ipc_status == IPC_EMPTY);
+
+  const int val = 42;
+  test_utils::write_data(buffer.get(), val);
+  test_utils::CHECK_OK(ipc_buffer_acquire(buffer.get(), &entry));
+  CHECK(entry.size == sizeof(int));
+  CHECK(*static_cast<int *>(entry.payload) == val);
+
+  IpcEntry other;
+  test_utils::CHECK_ERROR(ipc_buffer_acquire(buffer.get(), &other),
+                          IPC_ERR_LOCKED);
+  test_utils::CHECK_ERROR(ipc_buffer_read(buffer.get(), &other),
+                          IPC_ERR_LOCKED);
+
+  test_utils::CHECK_OK(ipc_buffer_release(buffer.get(), &entry));
+  test_utils::CHECK_ERROR(ipc_buffer_release(buffer.get(), &entry),
+                          IPC_ERR_ILLEGAL_STATE);
+  CHECK(ipc_buffer_peek(buffer.get(), &other).ipc_status == IPC_EMPTY);
+}
+
+TEST_CASE("acquire skips placeholder") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
+
+  std::vector<uint8_t> data(100, 0xAB);
+  test_utils::write_data(buffer.get(), 1);
+  test_utils::CHECK_OK(ipc_buffer_write(buffer.get(), data.data(), data.size()));
+  CHECK(test_utils::read_data<int>(buffer.get()) == 1);
+
+  IpcEntry entry;
+  test_utils::CHECK_OK(ipc_buffer_acquire(buffer.get(), &entry));
+  test_utils::CHECK_OK(ipc_buffer_release(buffer.get(), &entry));
+
+  test_utils::CHECK_OK(ipc_buffer_write(buffer.get(), data.data(), data.size()));
+  test_utils::CHECK_OK(ipc_buffer_acquire(buffer.get(), &entry));
+  CHECK(entry.offset == test_utils::SMALL_BUFFER_SIZE);
+  CHECK(entry.size == data.size());
+  CHECK(memcmp(entry.payload, data.data(), data.size()) == 0);
+  test_utils::CHECK_OK(ipc_buffer_release(buffer.get(), &entry));
+}
+
+TEST_CASE("concurrent write - acquire release") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_CONCURRENT_WRITE);
+
+  for (int i = 0; i < 32; i++) {
+    test_utils::write_data(buffer.get(), i);
+
+    IpcEntry entry;
+    test_utils::CHECK_OK(ipc_buffer_acquire(buffer.get(), &entry));
+    CHECK(*static_cast<int *>(entry.payload) == i);
+    test_utils::CHECK_OK(ipc_buffer_release(buffer.get(), &entry));
+  }
+}
+
+TEST_CASE("create with unsupported flags") {
+  std::vector<uint8_t> mem(ipc_buffer_suggest_size(128));
+  const IpcBufferOptions options = {.flags = 0x80000000u, .subscribers = 0};
+  test_utils::CHECK_ERROR(
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &options),
+      IPC_ERR_INVALID_ARGUMENT);
+  test_utils::CHECK_ERROR(
+      ipc_buffer_create_with_options(mem.data(), mem.size(), nullptr),
+      IPC_ERR_INVALID_ARGUMENT);
+}
+
+TEST_CASE("concurrent write - fill and drain with wrap") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_CONCURRENT_WRITE);
+
+  size_t next_write = 0;
+  size_t next_read = 0;
+  for (int round = 0; round < 10; round++) {
+    while (test_utils::write_data_safe(buffer.get(), next_write)) {
+      next_write++;
+    }
+
+    test_utils::EntryWrapper entry(sizeof(size_t));
+    for (;;) {
+      IpcEntry entry_ref = entry.get();
+      const IpcBufferReadResult result =
+          ipc_buffer_read(buffer.get(), &entry_ref);
+      if (result.ipc_status == IPC_EMPTY) {
+        break;
+      }
+
+      test_utils::CHECK_OK(result);
+      size_t val;
+      memcpy(&val, entry_ref.payload, sizeof(val));
+      CHECK(val == next_read);
+      next_read++;
+    }
+  }
+
+  CHECK(next_read == next_write);
+}
+
+TEST_CASE("concurrent write - reserved entry does not block writers") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_CONCURRENT_WRITE);
+
+  IpcSlot slot;
+  test_utils::CHECK_OK(ipc_buffer_reserve(buffer.get(), sizeof(int), &slot));
+
+  const int second = 2;
+  test_utils::write_data(buffer.get(), second);
+
+  test_utils::EntryWrapper entry(sizeof(int));
+  IpcEntry entry_ref = entry.get();
+  CHECK(ipc_buffer_read(buffer.get(), &entry_ref).ipc_status ==
+        IPC_ERR_NOT_READY);
+
+  const int first = 1;
+  memcpy(slot.payload, &first, sizeof(first));
+  test_utils::CHECK_OK(ipc_buffer_commit(buffer.get(), &slot));
+  test_utils::CHECK_ERROR(ipc_buffer_commit(buffer.get(), &slot),
+                          IPC_ERR_ILLEGAL_STATE);
+
+  CHECK(test_utils::read_data<int>(buffer.get()) == first);
+  CHECK(test_utils::read_data<int>(buffer.get()) == second);
+}
+
+TEST_CASE("concurrent write - aborted entry is skipped") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_CONCURRENT_WRITE);
+
+  IpcSlot slot;
+  test_utils::CHECK_OK(ipc_buffer_reserve(buffer.get(), sizeof(int), &slot));
+  const int val = 42;
+  test_utils::write_data(buffer.get(), val);
+  test_utils::CHECK_OK(ipc_buffer_abort(buffer.get(), &slot));
+  test_utils::CHECK_ERROR(ipc_buffer_abort(buffer.get(), &slot),
+                          IPC_ERR_ILLEGAL_STATE);
+
+  CHECK(test_utils::peek_data<int>(buffer.get()) == val);
+  CHECK(test_utils::read_data<int>(buffer.get()) == val);
+
+  IpcEntry entry;
+  CHECK(ipc_buffer_peek(buffer.get(), &entry).ipc_status == IPC_EMPTY);
+}
+
+TEST_CASE("concurrent write - skip_force waits for publication") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_CONCURRENT_WRITE);
+
+  IpcSlot slot;
+  test_utils::CHECK_OK(ipc_buffer_reserve(buffer.get(), sizeof(int), &slot));
+  test_utils::CHECK_ERROR(ipc_buffer_skip_force(buffer.get()),
+                          IPC_ERR_NOT_READY);
+
+  test_utils::CHECK_OK(ipc_buffer_commit(buffer.get(), &slot));
+  const IpcBufferSkipForceResult result = ipc_buffer_skip_force(buffer.get());
+  CHECK(result.ipc_status == IPC_OK);
+  CHECK(result.result == slot.offset);
+}
+
+TEST_CASE("concurrent write - attach picks up mode") {
+  std::vector<uint8_t> mem(ipc_buffer_suggest_size(128));
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_CONCURRENT_WRITE,
+                                    .subscribers = 0};
+  const IpcBufferCreateResult create_result =
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &options);
+  test_utils::CHECK_OK(create_result);
+
+  const IpcBufferAttachResult attach_result = ipc_buffer_attach(mem.data());
+  test_utils::CHECK_OK(attach_result);
+
+  IpcSlot slot;
+  test_utils::CHECK_OK(
+      ipc_buffer_reserve(create_result.result, sizeof(int), &slot));
+  const int val = 7;
+  test_utils::write_data(attach_result.result, val);
+  test_utils::CHECK_OK(ipc_buffer_abort(create_result.result, &slot));
+  CHECK(test_utils::read_data<int>(attach_result.result) == val);
+
+  free(create_result.result);
+  free(attach_result.result);
+}
+
+TEST_CASE("spsc - fill and drain with wrap") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_SPSC);
+
+  for (int round = 0; round < 20; round++) {
+    std::vector<uint8_t> data(40 + round, static_cast<uint8_t>(round));
+    test_utils::CHECK_OK(
+        ipc_buffer_write(buffer.get(), data.data(), data.size()));
+
+    test_utils::EntryWrapper entry(data.size());
+    IpcEntry entry_ref = entry.get();
+    test_utils::CHECK_OK(ipc_buffer_read(buffer.get(), &entry_ref));
+    CHECK(entry_ref.size == data.size());
+    CHECK(memcmp(entry_ref.payload, data.data(), data.size()) == 0);
+  }
+
+  IpcEntry entry;
+  CHECK(ipc_buffer_peek(buffer.get(), &entry).ipc_status == IPC_EMPTY);
+}
+
+TEST_CASE("spsc - reserve commit abort") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_SPSC);
+
+  IpcSlot slot;
+  test_utils::CHECK_OK(ipc_buffer_reserve(buffer.get(), sizeof(int), &slot));
+  test_utils::CHECK_OK(ipc_buffer_abort(buffer.get(), &slot));
+
+  IpcEntry entry;
+  CHECK(ipc_buffer_peek(buffer.get(), &entry).ipc_status == IPC_EMPTY);
+
+  test_utils::CHECK_OK(ipc_buffer_reserve(buffer.get(), sizeof(int), &slot));
+  *static_cast<int *>(slot.payload) = 5;
+  CHECK(ipc_buffer_peek(buffer.get(), &entry).ipc_status == IPC_EMPTY);
+  test_utils::CHECK_OK(ipc_buffer_commit(buffer.get(), &slot));
+  test_utils::CHECK_ERROR(ipc_buffer_commit(buffer.get(), &slot),
+                          IPC_ERR_ILLEGAL_STATE);
+
+  test_utils::CHECK_OK(ipc_buffer_acquire(buffer.get(), &entry));
+  CHECK(*static_cast<int *>(entry.payload) == 5);
+  test_utils::CHECK_OK(ipc_buffer_release(buffer.get(), &entry));
+  test_utils::CHECK_ERROR(ipc_buffer_release(buffer.get(), &entry),
+                          IPC_ERR_ILLEGAL_STATE);
+}
+
+TEST_CASE("spsc - rejects concurrent write") {
+  std::vector<uint8_t> mem(ipc_buffer_suggest_size(128));
+  const IpcBufferOptions options = {
+      .flags = IPC_BUFFER_SPSC | IPC_BUFFER_CONCURRENT_WRITE, .subscribers = 0};
+  test_utils::CHECK_ERROR(
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &options),
+      IPC_ERR_INVALID_ARGUMENT);
+}
+
+TEST_CASE("mpsc - producers keep tail protocol") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_MPSC);
+
+  IpcSlot slot;
+  test_utils::CHECK_OK(ipc_buffer_reserve(buffer.get(), sizeof(int), &slot));
+  test_utils::CHECK_ERROR(ipc_buffer_write(buffer.get(), &slot, sizeof(int)),
+                          IPC_ERR_LOCKED);
+  *static_cast<int *>(slot.payload) = 11;
+  test_utils::CHECK_OK(ipc_buffer_commit(buffer.get(), &slot));
+
+  for (int i = 0; i < 20; i++) {
+    test_utils::write_data(buffer.get(), i);
+    IpcEntry entry;
+    test_utils::CHECK_OK(ipc_buffer_peek(buffer.get(), &entry));
+    CHECK(*static_cast<int *>(entry.payload) == (i == 0 ? 11 : i - 1));
+    test_utils::CHECK_OK(ipc_buffer_skip(buffer.get(), entry.offset));
+  }
+  CHECK(test_utils::read_data<int>(buffer.get()) == 19);
+}
+
+TEST_CASE("mpsc - rejects spsc") {
+  std::vector<uint8_t> mem(ipc_buffer_suggest_size(128));
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_SPSC | IPC_BUFFER_MPSC,
+                                    .subscribers = 0};
+  test_utils::CHECK_ERROR(
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &options),
+      IPC_ERR_INVALID_ARGUMENT);
+}
+
+static size_t fill_until_full(IpcBuffer *buffer, size_t payload_size) {
+  std::vector<uint8_t> data(payload_size, 0x5A);
+  size_t count = 0;
+  while (ipc_buffer_write(buffer, data.data(), data.size()).ipc_status ==
+         IPC_OK) {
+    count++;
+  }
+  return count;
+}
+
+TEST_CASE("compact - fits twice as many small entries") {
+  test_utils::BufferWrapper wide(test_utils::SMALL_BUFFER_SIZE);
+  test_utils::BufferWrapper compact(test_utils::SMALL_BUFFER_SIZE,
+                                    IPC_BUFFER_COMPACT_ENTRIES);
+
+  CHECK(fill_until_full(compact.get(), sizeof(uint64_t)) >=
+        2 * fill_until_full(wide.get(), sizeof(uint64_t)));
+}
+
+TEST_CASE("compact - fill and drain with wrap") {
+  for (const uint32_t flags :
+       {IPC_BUFFER_COMPACT_ENTRIES,
+        IPC_BUFFER_COMPACT_ENTRIES | IPC_BUFFER_CONCURRENT_WRITE,
+        IPC_BUFFER_COMPACT_ENTRIES | IPC_BUFFER_SPSC}) {
+    test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE, flags);
+
+    for (int round = 0; round < 40; round++) {
+      std::vector<uint8_t> data(1 + round % 30, static_cast<uint8_t>(round));
+      test_utils::CHECK_OK(
+          ipc_buffer_write(buffer.get(), data.data(), data.size()));
+
+      test_utils::EntryWrapper entry(data.size());
+      IpcEntry entry_ref = entry.get();
+      test_utils::CHECK_OK(ipc_buffer_read(buffer.get(), &entry_ref));
+      CHECK(entry_ref.size == data.size());
+      CHECK(memcmp(entry_ref.payload, data.data(), data.size()) == 0);
+    }
+
+    IpcEntry entry;
+    CHECK(ipc_buffer_peek(buffer.get(), &entry).ipc_status == IPC_EMPTY);
+  }
+}
+
+TEST_CASE("compact - abort and batch") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_COMPACT_ENTRIES |
+                                       IPC_BUFFER_CONCURRENT_WRITE);
+
+  IpcSlot slot;
+  test_utils::CHECK_OK(ipc_buffer_reserve(buffer.get(), 20, &slot));
+  test_utils::CHECK_OK(ipc_buffer_abort(buffer.get(), &slot));
+  test_utils::CHECK_ERROR(ipc_buffer_commit(buffer.get(), &slot),
+                          IPC_ERR_ILLEGAL_STATE);
+
+  int values[3] = {1, 2, 3};
+  IpcMessage messages[] = {{&values[0], sizeof(int)},
+                           {&values[1], sizeof(int)},
+                           {&values[2], sizeof(int)}};
+  const IpcBufferWriteBatchResult result =
+      ipc_buffer_write_batch(buffer.get(), messages, 3);
+  test_utils::CHECK_OK(result);
+  CHECK(result.result == 3);
+
+  for (int i = 1; i <= 3; i++) {
+    CHECK(test_utils::read_data<int>(buffer.get()) == i);
+  }
+}
+
+TEST_CASE("attach with options enforces mode") {
+  std::vector<uint8_t> mem(ipc_buffer_suggest_size(128));
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_SPSC, .subscribers = 0};
+  const IpcBufferCreateResult create_result =
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &options);
+  test_utils::CHECK_OK(create_result);
+
+  const IpcBufferOptions mpmc = {.flags = 0, .subscribers = 0};
+  test_utils::CHECK_ERROR(ipc_buffer_attach_with_options(mem.data(), &mpmc),
+                          IPC_ERR_ILLEGAL_STATE);
+
+  const IpcBufferAttachResult attach_result =
+      ipc_buffer_attach_with_options(mem.data(), &options);
+  test_utils::CHECK_OK(attach_result);
+
+  const int val = 3;
+  test_utils::write_data(create_result.result, val);
+  CHECK(test_utils::read_data<int>(attach_result.result) == val);
+
+  free(create_result.result);
+  free(attach_result.result);
+}
+
 TEST_CASE("buffer integration - write peek skip sequence") {
   test_utils::BufferWrapper buffer(test_utils::MEDIUM_BUFFER_SIZE);
 
@@ -904,3 +1586,472 @@ TEST_CASE("buffer data - different sizes") {
   IpcBufferReadResult read_result = ipc_buffer_read(buffer.get(), &entry_ref);
   CHECK(read_result.ipc_status == IPC_EMPTY);
 }
+
+TEST_CASE("broadcast - invalid options") {
+  std::vector<uint8_t> mem(4096);
+  const size_t size = ipc_buffer_suggest_size(test_utils::SMALL_BUFFER_SIZE);
+  const IpcBufferOptions no_slots = {.flags = IPC_BUFFER_BROADCAST,
+                                     .subscribers = 0};
+  test_utils::CHECK_ERROR(
+      ipc_buffer_create_with_options(mem.data(), size, &no_slots),
+      IPC_ERR_INVALID_ARGUMENT);
+
+  const IpcBufferOptions no_flag = {.flags = 0, .subscribers = 2};
+  test_utils::CHECK_ERROR(
+      ipc_buffer_create_with_options(mem.data(), size, &no_flag),
+      IPC_ERR_INVALID_ARGUMENT);
+
+  const IpcBufferOptions concurrent = {
+      .flags = IPC_BUFFER_BROADCAST | IPC_BUFFER_CONCURRENT_WRITE,
+      .subscribers = 2};
+  test_utils::CHECK_ERROR(
+      ipc_buffer_create_with_options(
+          mem.data(), ipc_buffer_suggest_size_with_options(256, &concurrent),
+          &concurrent),
+      IPC_ERR_INVALID_ARGUMENT);
+
+  test_utils::BufferWrapper plain(test_utils::SMALL_BUFFER_SIZE);
+  test_utils::CHECK_ERROR(ipc_buffer_subscribe(plain.get()),
+                          IPC_ERR_INVALID_ARGUMENT);
+}
+
+TEST_CASE("broadcast - every subscriber reads every entry") {
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_BROADCAST,
+                                    .subscribers = 2};
+  std::vector<uint8_t> mem(ipc_buffer_suggest_size_with_options(
+      test_utils::SMALL_BUFFER_SIZE, &options));
+  const IpcBufferCreateResult created =
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &options);
+  test_utils::CHECK_OK(created);
+  IpcBuffer *writer = created.result;
+
+  IpcBuffer *first = ipc_buffer_attach(mem.data()).result;
+  IpcBuffer *second = ipc_buffer_attach(mem.data()).result;
+
+  test_utils::EntryWrapper entry(sizeof(uint64_t));
+  IpcEntry dest = entry.get();
+  test_utils::CHECK_ERROR(ipc_buffer_read(first, &dest),
+                          IPC_ERR_ILLEGAL_STATE);
+
+  const IpcBufferSubscribeResult first_slot = ipc_buffer_subscribe(first);
+  test_utils::CHECK_OK(first_slot);
+  const IpcBufferSubscribeResult second_slot = ipc_buffer_subscribe(second);
+  test_utils::CHECK_OK(second_slot);
+  CHECK(first_slot.result != second_slot.result);
+  test_utils::CHECK_ERROR(ipc_buffer_subscribe(first), IPC_ERR_ILLEGAL_STATE);
+
+  for (uint64_t i = 0; i < 3; i++) {
+    test_utils::CHECK_OK(ipc_buffer_write(writer, &i, sizeof(i)));
+  }
+
+  for (IpcBuffer *reader : {first, second}) {
+    for (uint64_t i = 0; i < 3; i++) {
+      dest = entry.get();
+      test_utils::CHECK_OK(ipc_buffer_read(reader, &dest));
+      CHECK(*(uint64_t *)dest.payload == i);
+    }
+
+    dest = entry.get();
+    const IpcBufferReadResult empty = ipc_buffer_read(reader, &dest);
+    CHECK(IpcBufferReadResult_is_ok(empty));
+    CHECK(empty.ipc_status == IPC_EMPTY);
+  }
+
+  free(second);
+  free(first);
+  free(writer);
+}
+
+TEST_CASE("broadcast - writer is gated by the slowest subscriber") {
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_BROADCAST,
+                                    .subscribers = 2};
+  std::vector<uint8_t> mem(ipc_buffer_suggest_size_with_options(
+      test_utils::SMALL_BUFFER_SIZE, &options));
+  IpcBuffer *writer =
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &options).result;
+  IpcBuffer *fast = ipc_buffer_attach(mem.data()).result;
+  IpcBuffer *slow = ipc_buffer_attach(mem.data()).result;
+  test_utils::CHECK_OK(ipc_buffer_subscribe(fast));
+  test_utils::CHECK_OK(ipc_buffer_subscribe(slow));
+
+  // 7 entries of 32 bytes, the last 32 bytes of the ring are a placeholder
+  uint64_t value = 0;
+  for (; value < 7; value++) {
+    test_utils::CHECK_OK(ipc_buffer_write(writer, &value, sizeof(value)));
+  }
+  test_utils::CHECK_ERROR(ipc_buffer_write(writer, &value, sizeof(value)),
+                          IPC_ERR_NO_SPACE_CONTIGUOUS);
+
+  test_utils::EntryWrapper entry(sizeof(uint64_t));
+  for (int i = 0; i < 7; i++) {
+    IpcEntry dest = entry.get();
+    test_utils::CHECK_OK(ipc_buffer_read(fast, &dest));
+  }
+  test_utils::CHECK_ERROR(ipc_buffer_write(writer, &value, sizeof(value)),
+                          IPC_ERR_NO_SPACE_CONTIGUOUS);
+
+  IpcEntry dest = entry.get();
+  test_utils::CHECK_OK(ipc_buffer_read(slow, &dest));
+  CHECK(*(uint64_t *)dest.payload == 0);
+  test_utils::CHECK_OK(ipc_buffer_write(writer, &value, sizeof(value)));
+
+  // a departed subscriber no longer holds the writer back
+  test_utils::CHECK_OK(ipc_buffer_unsubscribe(slow));
+  test_utils::CHECK_ERROR(ipc_buffer_unsubscribe(slow), IPC_ERR_ILLEGAL_STATE);
+  dest = entry.get();
+  test_utils::CHECK_OK(ipc_buffer_read(fast, &dest));
+  CHECK(*(uint64_t *)dest.payload == 7);
+  for (value = 8; value < 14; value++) {
+    test_utils::CHECK_OK(ipc_buffer_write(writer, &value, sizeof(value)));
+  }
+
+  free(slow);
+  free(fast);
+  free(writer);
+}
+
+TEST_CASE("broadcast - subscriber starts at the tail") {
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_BROADCAST,
+                                    .subscribers = 1};
+  std::vector<uint8_t> mem(ipc_buffer_suggest_size_with_options(
+      test_utils::SMALL_BUFFER_SIZE, &options));
+  IpcBuffer *writer =
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &options).result;
+
+  // without subscribers nothing is kept, the writer never runs out of space
+  for (uint64_t i = 0; i < 100; i++) {
+    test_utils::CHECK_OK(ipc_buffer_write(writer, &i, sizeof(i)));
+  }
+
+  IpcBuffer *reader = ipc_buffer_attach(mem.data()).result;
+  IpcBuffer *other = ipc_buffer_attach(mem.data()).result;
+  test_utils::CHECK_OK(ipc_buffer_subscribe(reader));
+  test_utils::CHECK_ERROR(ipc_buffer_subscribe(other), IPC_ERR_ILLEGAL_STATE);
+
+  test_utils::EntryWrapper entry(sizeof(uint64_t));
+  IpcEntry dest = entry.get();
+  const IpcBufferReadResult empty = ipc_buffer_read(reader, &dest);
+  CHECK(IpcBufferReadResult_is_ok(empty));
+  CHECK(empty.ipc_status == IPC_EMPTY);
+
+  const uint64_t value = 100;
+  test_utils::CHECK_OK(ipc_buffer_write(writer, &value, sizeof(value)));
+  dest = entry.get();
+  test_utils::CHECK_OK(ipc_buffer_read(reader, &dest));
+  CHECK(*(uint64_t *)dest.payload == value);
+
+  free(other);
+  free(reader);
+  free(writer);
+}
+
+TEST_CASE("consumer groups - members split, groups each see every entry") {
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_BROADCAST,
+                                    .subscribers = 2};
+  std::vector<uint8_t> mem(ipc_buffer_suggest_size_with_options(
+      test_utils::SMALL_BUFFER_SIZE, &options));
+  IpcBuffer *writer =
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &options).result;
+  IpcBuffer *a1 = ipc_buffer_attach(mem.data()).result;
+  IpcBuffer *a2 = ipc_buffer_attach(mem.data()).result;
+  IpcBuffer *b1 = ipc_buffer_attach(mem.data()).result;
+  IpcBuffer *c1 = ipc_buffer_attach(mem.data()).result;
+
+  const IpcBufferJoinGroupResult a1_slot = ipc_buffer_join_group(a1, "a");
+  test_utils::CHECK_OK(a1_slot);
+  const IpcBufferJoinGroupResult a2_slot = ipc_buffer_join_group(a2, "a");
+  test_utils::CHECK_OK(a2_slot);
+  CHECK(a1_slot.result == a2_slot.result);
+  const IpcBufferJoinGroupResult b1_slot = ipc_buffer_join_group(b1, "b");
+  test_utils::CHECK_OK(b1_slot);
+  CHECK(b1_slot.result != a1_slot.result);
+  test_utils::CHECK_ERROR(ipc_buffer_join_group(c1, "c"),
+                          IPC_ERR_ILLEGAL_STATE);
+  test_utils::CHECK_ERROR(ipc_buffer_join_group(a1, "b"),
+                          IPC_ERR_ILLEGAL_STATE);
+
+  for (uint64_t i = 0; i < 6; i++) {
+    test_utils::CHECK_OK(ipc_buffer_write(writer, &i, sizeof(i)));
+  }
+
+  // group a takes turns, every entry is read by exactly one of its members
+  test_utils::EntryWrapper entry(sizeof(uint64_t));
+  for (uint64_t i = 0; i < 6; i++) {
+    IpcEntry dest = entry.get();
+    test_utils::CHECK_OK(ipc_buffer_read(i % 2 == 0 ? a1 : a2, &dest));
+    CHECK(*(uint64_t *)dest.payload == i);
+  }
+  IpcEntry dest = entry.get();
+  const IpcBufferReadResult empty = ipc_buffer_read(a2, &dest);
+  CHECK(IpcBufferReadResult_is_ok(empty));
+  CHECK(empty.ipc_status == IPC_EMPTY);
+
+  for (uint64_t i = 0; i < 6; i++) {
+    dest = entry.get();
+    test_utils::CHECK_OK(ipc_buffer_read(b1, &dest));
+    CHECK(*(uint64_t *)dest.payload == i);
+  }
+
+  free(c1);
+  free(b1);
+  free(a2);
+  free(a1);
+  free(writer);
+}
+
+TEST_CASE("consumer groups - invalid names and modes") {
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_BROADCAST,
+                                    .subscribers = 1};
+  std::vector<uint8_t> mem(ipc_buffer_suggest_size_with_options(
+      test_utils::SMALL_BUFFER_SIZE, &options));
+  IpcBuffer *buffer =
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &options).result;
+
+  const std::string long_name(IPC_BUFFER_GROUP_NAME_MAX, 'x');
+  test_utils::CHECK_ERROR(ipc_buffer_join_group(nullptr, "a"),
+                          IPC_ERR_INVALID_ARGUMENT);
+  test_utils::CHECK_ERROR(ipc_buffer_join_group(buffer, nullptr),
+                          IPC_ERR_INVALID_ARGUMENT);
+  test_utils::CHECK_ERROR(ipc_buffer_join_group(buffer, ""),
+                          IPC_ERR_INVALID_ARGUMENT);
+  test_utils::CHECK_ERROR(ipc_buffer_join_group(buffer, long_name.c_str()),
+                          IPC_ERR_INVALID_ARGUMENT);
+  test_utils::CHECK_OK(ipc_buffer_join_group(
+      buffer, long_name.substr(1).c_str()));
+  test_utils::CHECK_OK(ipc_buffer_unsubscribe(buffer));
+
+  // an anonymous subscriber is not a group
+  IpcBuffer *anonymous = ipc_buffer_attach(mem.data()).result;
+  test_utils::CHECK_OK(ipc_buffer_subscribe(anonymous));
+  test_utils::CHECK_ERROR(ipc_buffer_join_group(buffer, "a"),
+                          IPC_ERR_ILLEGAL_STATE);
+  test_utils::CHECK_OK(ipc_buffer_unsubscribe(anonymous));
+
+  const IpcBufferOptions spsc = {.flags =
+                                     IPC_BUFFER_BROADCAST | IPC_BUFFER_SPSC,
+                                 .subscribers = 1};
+  std::vector<uint8_t> spsc_mem(ipc_buffer_suggest_size_with_options(
+      test_utils::SMALL_BUFFER_SIZE, &spsc));
+  IpcBuffer *first =
+      ipc_buffer_create_with_options(spsc_mem.data(), spsc_mem.size(), &spsc)
+          .result;
+  IpcBuffer *second = ipc_buffer_attach(spsc_mem.data()).result;
+  test_utils::CHECK_OK(ipc_buffer_join_group(first, "a"));
+  test_utils::CHECK_ERROR(ipc_buffer_join_group(second, "a"),
+                          IPC_ERR_ILLEGAL_STATE);
+
+  test_utils::BufferWrapper plain(test_utils::SMALL_BUFFER_SIZE);
+  test_utils::CHECK_ERROR(ipc_buffer_join_group(plain.get(), "a"),
+                          IPC_ERR_INVALID_ARGUMENT);
+
+  free(second);
+  free(first);
+  free(anonymous);
+  free(buffer);
+}
+
+TEST_CASE("consumer groups - last member leaving frees the slot") {
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_BROADCAST,
+                                    .subscribers = 1};
+  std::vector<uint8_t> mem(ipc_buffer_suggest_size_with_options(
+      test_utils::SMALL_BUFFER_SIZE, &options));
+  IpcBuffer *writer =
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &options).result;
+  IpcBuffer *first = ipc_buffer_attach(mem.data()).result;
+  IpcBuffer *second = ipc_buffer_attach(mem.data()).result;
+
+  test_utils::CHECK_OK(ipc_buffer_join_group(first, "a"));
+  test_utils::CHECK_OK(ipc_buffer_join_group(second, "a"));
+  const uint64_t value = 1;
+  test_utils::CHECK_OK(ipc_buffer_write(writer, &value, sizeof(value)));
+
+  // the group and its position survive while a member is left
+  test_utils::CHECK_OK(ipc_buffer_unsubscribe(first));
+  test_utils::CHECK_ERROR(ipc_buffer_join_group(first, "b"),
+                          IPC_ERR_ILLEGAL_STATE);
+  test_utils::EntryWrapper entry(sizeof(uint64_t));
+  IpcEntry dest = entry.get();
+  test_utils::CHECK_OK(ipc_buffer_read(second, &dest));
+  CHECK(*(uint64_t *)dest.payload == value);
+
+  test_utils::CHECK_OK(ipc_buffer_unsubscribe(second));
+  test_utils::CHECK_OK(ipc_buffer_join_group(first, "b"));
+
+  free(second);
+  free(first);
+  free(writer);
+}
+
+TEST_CASE("overwrite - invalid options") {
+  std::vector<uint8_t> mem(
+      ipc_buffer_suggest_size(test_utils::SMALL_BUFFER_SIZE));
+  const IpcBufferOptions concurrent = {
+      .flags = IPC_BUFFER_OVERWRITE | IPC_BUFFER_CONCURRENT_WRITE,
+      .subscribers = 0};
+  test_utils::CHECK_ERROR(
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &concurrent),
+      IPC_ERR_INVALID_ARGUMENT);
+
+  const IpcBufferOptions broadcast = {
+      .flags = IPC_BUFFER_OVERWRITE | IPC_BUFFER_BROADCAST, .subscribers = 1};
+  std::vector<uint8_t> broadcast_mem(ipc_buffer_suggest_size_with_options(
+      test_utils::SMALL_BUFFER_SIZE, &broadcast));
+  test_utils::CHECK_ERROR(
+      ipc_buffer_create_with_options(broadcast_mem.data(),
+                                     broadcast_mem.size(), &broadcast),
+      IPC_ERR_INVALID_ARGUMENT);
+}
+
+TEST_CASE("overwrite - writer drops the oldest entries") {
+  for (const uint32_t flags :
+       {0u, IPC_BUFFER_SPSC, IPC_BUFFER_MPSC, IPC_BUFFER_COMPACT_ENTRIES}) {
+    test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                     IPC_BUFFER_OVERWRITE | flags);
+
+    // far more than the ring holds, none of them may fail
+    const uint64_t total = 50;
+    for (uint64_t i = 0; i < total; i++) {
+      test_utils::CHECK_OK(ipc_buffer_write(buffer.get(), &i, sizeof(i)));
+    }
+
+    uint64_t value = 0;
+    uint64_t lost = 0;
+    IpcEntry dest = {.offset = 0, .payload = &value, .size = sizeof(value)};
+    test_utils::CHECK_OK(ipc_buffer_read_lossy(buffer.get(), &dest, &lost));
+    CHECK(lost > 0);
+    // lost entries are exactly the ones in front of the oldest survivor
+    CHECK(value == lost);
+
+    uint64_t expected = value + 1;
+    for (;;) {
+      dest = {.offset = 0, .payload = &value, .size = sizeof(value)};
+      const IpcBufferReadResult read =
+          ipc_buffer_read_lossy(buffer.get(), &dest, &lost);
+      REQUIRE(IpcBufferReadResult_is_ok(read));
+      CHECK(lost == 0);
+      if (read.ipc_status == IPC_EMPTY) {
+        break;
+      }
+
+      CHECK(value == expected);
+      expected++;
+    }
+    CHECK(expected == total);
+  }
+}
+
+TEST_CASE("overwrite - reader keeps up without losses") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_OVERWRITE);
+  for (uint64_t i = 0; i < 100; i++) {
+    test_utils::CHECK_OK(ipc_buffer_write(buffer.get(), &i, sizeof(i)));
+    uint64_t value = 0;
+    uint64_t lost = 1;
+    IpcEntry dest = {.offset = 0, .payload = &value, .size = sizeof(value)};
+    test_utils::CHECK_OK(ipc_buffer_read_lossy(buffer.get(), &dest, &lost));
+    CHECK(lost == 0);
+    CHECK(value == i);
+  }
+}
+
+TEST_CASE("overwrite - batch into a full ring") {
+  for (const uint32_t flags :
+       {0u, IPC_BUFFER_SPSC, IPC_BUFFER_COMPACT_ENTRIES}) {
+    test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                     IPC_BUFFER_OVERWRITE | flags);
+
+    // small and large entries in turn, so some batches start right before
+    // the wrap point with an entry that does not fit behind its placeholder
+    uint64_t small = 0;
+    uint64_t large[25] = {};
+    uint64_t written = 0;
+    for (uint64_t i = 0; i < 40; i++) {
+      small = written++;
+      large[0] = written++;
+      const IpcMessage messages[] = {{.data = &small, .size = sizeof(small)},
+                                     {.data = large, .size = sizeof(large)}};
+      size_t sent = 0;
+      while (sent < 2) {
+        const IpcBufferWriteBatchResult result =
+            ipc_buffer_write_batch(buffer.get(), messages + sent, 2 - sent);
+        REQUIRE(result.ipc_status == IPC_OK);
+        REQUIRE(result.result > 0);
+        sent += result.result;
+      }
+    }
+
+    uint64_t received = 0;
+    uint64_t lost = 0;
+    uint64_t last = 0;
+    for (;;) {
+      uint64_t payload[25] = {};
+      uint64_t lapped = 0;
+      IpcEntry dest = {
+          .offset = 0, .payload = payload, .size = sizeof(payload)};
+      const IpcBufferReadResult read =
+          ipc_buffer_read_lossy(buffer.get(), &dest, &lapped);
+      REQUIRE(IpcBufferReadResult_is_ok(read));
+      lost += lapped;
+      if (read.ipc_status == IPC_EMPTY) {
+        break;
+      }
+
+      CHECK((received == 0 || payload[0] > last));
+      last = payload[0];
+      received++;
+    }
+    CHECK(lost > 0);
+    CHECK(last == written - 1);
+    CHECK(received + lost == written);
+  }
+}
+
+TEST_CASE("overwrite - zero-copy views") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_OVERWRITE);
+  const uint64_t value = 42;
+  test_utils::CHECK_OK(ipc_buffer_write(buffer.get(), &value, sizeof(value)));
+
+  IpcEntry entry;
+  test_utils::CHECK_ERROR(ipc_buffer_acquire(buffer.get(), &entry),
+                          IPC_ERR_INVALID_ARGUMENT);
+  std::vector<int> values;
+  test_utils::CHECK_ERROR(
+      ipc_buffer_read_batch(buffer.get(), 1, collect_ints, &values),
+      IPC_ERR_INVALID_ARGUMENT);
+  CHECK(values.empty());
+
+  // peek still reports the next entry, just not its bytes
+  test_utils::CHECK_OK(ipc_buffer_peek(buffer.get(), &entry));
+  CHECK(entry.payload == nullptr);
+  CHECK(entry.size == sizeof(value));
+
+  uint64_t read_value = 0;
+  uint64_t lost = 1;
+  IpcEntry dest = {
+      .offset = 0, .payload = &read_value, .size = sizeof(read_value)};
+  test_utils::CHECK_OK(ipc_buffer_read_lossy(buffer.get(), &dest, &lost));
+  CHECK(read_value == value);
+  CHECK(lost == 0);
+}
+
+TEST_CASE("read lossy - arguments and plain buffers") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
+  uint64_t value = 7;
+  test_utils::CHECK_OK(ipc_buffer_write(buffer.get(), &value, sizeof(value)));
+
+  IpcEntry dest = {.offset = 0, .payload = &value, .size = sizeof(value)};
+  test_utils::CHECK_ERROR(ipc_buffer_read_lossy(buffer.get(), &dest, NULL),
+                          IPC_ERR_INVALID_ARGUMENT);
+
+  uint64_t lost = 1;
+  value = 0;
+  test_utils::CHECK_OK(ipc_buffer_read_lossy(buffer.get(), &dest, &lost));
+  CHECK(value == 7);
+  CHECK(lost == 0);
+
+  lost = 1;
+  CHECK(ipc_buffer_read_lossy(buffer.get(), &dest, &lost).ipc_status ==
+        IPC_EMPTY);
+  CHECK(lost == 0);
+}
@@ -5,6 +5,9 @@
 #include "concurrent_test_utils.h"
 #include "test_utils.h"
 #include "unsafe_collector.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iterator>
 #include <thread>
 #include <unordered_set>
 
@@ -27,6 +30,26 @@ TEST_CASE("single writer single reader") {
   }
 }
 
+TEST_CASE("single writer single reader - spsc") {
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_SPSC);
+  UnsafeCollector<size_t> collector;
+  ConcurrencyManager<size_t> manager;
+
+  manager.add_producer(concurrent_test_utils::produce_buffer, buffer.get(), 0,
+                       test_utils::LARGE_COUNT);
+  manager.add_consumer(concurrent_test_utils::consume_buffer, buffer.get(),
+                       std::ref(collector), std::ref(manager.get_manager()));
+
+  manager.run_and_wait();
+
+  auto collected = collector.get_all_collected();
+  CHECK(collected.size() == test_utils::LARGE_COUNT);
+  for (size_t i = 0; i < test_utils::LARGE_COUNT; i++) {
+    CHECK(collected.contains(i));
+  }
+}
+
 TEST_CASE("multiple writer single reader") {
   test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
   UnsafeCollector<size_t> collector;
@@ -52,6 +75,33 @@ TEST_CASE("multiple writer single reader") {
   }
 }
 
+TEST_CASE("multiple writer single reader - mpsc") {
+  const size_t total = test_utils::LARGE_COUNT;
+  for (const uint32_t flags :
+       {IPC_BUFFER_MPSC, IPC_BUFFER_MPSC | IPC_BUFFER_CONCURRENT_WRITE,
+        IPC_BUFFER_MPSC | IPC_BUFFER_CONCURRENT_WRITE |
+            IPC_BUFFER_COMPACT_ENTRIES}) {
+    test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE, flags);
+    UnsafeCollector<size_t> collector;
+    ConcurrencyManager<size_t> manager;
+
+    for (size_t i = 0; i < 3; i++) {
+      manager.add_producer(concurrent_test_utils::produce_buffer, buffer.get(),
+                           i * total / 3, (i + 1) * total / 3);
+    }
+
+    manager.add_consumer(concurrent_test_utils::consume_buffer, buffer.get(),
+                         std::ref(collector), std::ref(manager.get_manager()));
+    manager.run_and_wait();
+
+    auto collected = collector.get_all_collected();
+    CHECK(collected.size() == total);
+    for (size_t i = 0; i < total; i++) {
+      CHECK(collected.contains(i));
+    }
+  }
+}
+
 TEST_CASE("multiple writer multiple reader") {
   const size_t total = test_utils::LARGE_COUNT;
   test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
@@ -130,6 +180,192 @@ TEST_CASE("multiple writer multiple reader stress") {
   }
 }
 
+TEST_CASE("multiple writer multiple reader - concurrent write") {
+  const size_t total = test_utils::LARGE_COUNT;
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_CONCURRENT_WRITE);
+  UnsafeCollector<size_t> collector1, collector2;
+  ConcurrencyManager<size_t> manager;
+
+  for (size_t i = 0; i < 4; i++) {
+    manager.add_producer(concurrent_test_utils::produce_buffer, buffer.get(),
+                         i * total / 4, (i + 1) * total / 4);
+  }
+
+  manager.add_consumer(concurrent_test_utils::consume_buffer, buffer.get(),
+                       std::ref(collector1), std::ref(manager.get_manager()));
+  manager.add_consumer(concurrent_test_utils::consume_buffer, buffer.get(),
+                       std::ref(collector2), std::ref(manager.get_manager()));
+
+  manager.run_and_wait();
+
+  std::unordered_set<size_t> all_collected = collector1.get_all_collected();
+  auto collected2 = collector2.get_all_collected();
+  all_collected.insert(collected2.begin(), collected2.end());
+
+  CHECK(collector1.size() + collector2.size() == total);
+  CHECK(all_collected.size() == total);
+  for (size_t i = 0; i < total; i++) {
+    CHECK(all_collected.contains(i));
+  }
+}
+
+TEST_CASE("single writer broadcast readers") {
+  const size_t total = test_utils::LARGE_COUNT / 5;
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_BROADCAST,
+                                    .subscribers = 2};
+  std::vector<uint8_t> mem(ipc_buffer_suggest_size_with_options(
+      test_utils::SMALL_BUFFER_SIZE, &options));
+  IpcBuffer *writer =
+      ipc_buffer_create_with_options(mem.data(), mem.size(), &options).result;
+
+  std::vector<IpcBuffer *> readers;
+  for (size_t i = 0; i < 2; i++) {
+    readers.push_back(ipc_buffer_attach(mem.data()).result);
+    REQUIRE(IpcBufferSubscribeResult_is_ok(ipc_buffer_subscribe(readers[i])));
+  }
+
+  std::vector<size_t> received(readers.size(), 0);
+  // not vector<bool>, readers update their own element concurrently
+  std::vector<int> in_order(readers.size(), 1);
+  std::vector<std::thread> threads;
+  threads.emplace_back([writer, total] {
+    for (size_t i = 0; i < total; i++) {
+      while (ipc_buffer_write(writer, &i, sizeof(i)).ipc_status != IPC_OK) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  for (size_t r = 0; r < readers.size(); r++) {
+    threads.emplace_back([&, r] {
+      size_t value = 0;
+      while (received[r] < total) {
+        IpcEntry entry = {
+            .offset = 0, .payload = &value, .size = sizeof(value)};
+        if (ipc_buffer_read(readers[r], &entry).ipc_status != IPC_OK) {
+          std::this_thread::yield();
+          continue;
+        }
+
+        in_order[r] = in_order[r] && value == received[r];
+        received[r]++;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (size_t r = 0; r < readers.size(); r++) {
+    CHECK(received[r] == total);
+    CHECK(in_order[r]);
+    free(readers[r]);
+  }
+  free(writer);
+}
+
+TEST_CASE("overwrite - reader never sees a torn entry") {
+  constexpr size_t words = 8;
+  const uint64_t total = test_utils::LARGE_COUNT;
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_OVERWRITE | IPC_BUFFER_SPSC);
+
+  std::atomic<bool> done{false};
+  std::atomic<bool> writes_ok{true};
+  std::thread writer([&] {
+    uint64_t payload[words];
+    for (uint64_t i = 0; i < total; i++) {
+      std::fill(std::begin(payload), std::end(payload), i);
+      // the writer laps a stalled reader instead of failing
+      if (ipc_buffer_write(buffer.get(), payload, sizeof(payload))
+              .ipc_status != IPC_OK) {
+        writes_ok.store(false);
+      }
+    }
+    done.store(true);
+  });
+
+  uint64_t received = 0;
+  uint64_t lost = 0;
+  uint64_t last = 0;
+  bool intact = true;
+  bool in_order = true;
+  for (;;) {
+    const bool finished = done.load();
+    uint64_t payload[words];
+    IpcEntry entry = {.offset = 0, .payload = payload, .size = sizeof(payload)};
+    uint64_t lapped = 0;
+    const IpcBufferReadResult result =
+        ipc_buffer_read_lossy(buffer.get(), &entry, &lapped);
+    REQUIRE(IpcBufferReadResult_is_ok(result));
+    lost += lapped;
+    if (result.ipc_status == IPC_EMPTY) {
+      if (finished) {
+        break;
+      }
+      continue;
+    }
+
+    for (size_t w = 1; w < words; w++) {
+      intact = intact && payload[w] == payload[0];
+    }
+    in_order = in_order && (received == 0 || payload[0] > last);
+    last = payload[0];
+    received++;
+  }
+  writer.join();
+
+  CHECK(writes_ok.load());
+  CHECK(intact);
+  CHECK(in_order);
+  CHECK(last == total - 1);
+  CHECK(received + lost == total);
+}
+
+TEST_CASE("overwrite - lapped reads keep the caller's capacity") {
+  constexpr size_t words = 8;
+  const uint64_t total = test_utils::LARGE_COUNT;
+  test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE,
+                                   IPC_BUFFER_OVERWRITE | IPC_BUFFER_SPSC);
+
+  // sizes cycle through 1..words words, a read that starts over after being
+  // lapped must still fit the largest one into the caller's buffer
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    uint64_t payload[words];
+    for (uint64_t i = 0; i < total; i++) {
+      std::fill(std::begin(payload), std::end(payload), i);
+      ipc_buffer_write(buffer.get(), payload,
+                       (i % words + 1) * sizeof(uint64_t));
+      // keeps the two interleaved on a single core as well
+      std::this_thread::yield();
+    }
+    done.store(true);
+  });
+
+  bool reads_ok = true;
+  bool sized = true;
+  for (;;) {
+    const bool finished = done.load();
+    uint64_t payload[words];
+    IpcEntry entry = {.offset = 0, .payload = payload, .size = sizeof(payload)};
+    const IpcBufferReadResult result = ipc_buffer_read(buffer.get(), &entry);
+    reads_ok = reads_ok && IpcBufferReadResult_is_ok(result);
+    if (result.ipc_status != IPC_OK) {
+      if (finished || !reads_ok) {
+        break;
+      }
+      continue;
+    }
+
+    sized = sized && entry.size == (payload[0] % words + 1) * sizeof(uint64_t);
+  }
+  writer.join();
+
+  CHECK(reads_ok);
+  CHECK(sized);
+}
+
 TEST_CASE("race between skip and read") {
   for (int i = 0; i < 1000; i++) {
     test_utils::BufferWrapper buffer(test_utils::SMALL_BUFFER_SIZE);
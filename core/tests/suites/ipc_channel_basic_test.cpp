@@ -8,11 +8,17 @@
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <poll.h>
 #include <vector>
 
 namespace {
 constexpr struct timespec DEFAULT_TIMEOUT = {0, 100000000}; // 100ms
+
+bool is_readable(const int fd) {
+  struct pollfd pfd = {.fd = fd, .events = POLLIN, .revents = 0};
+  return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN) != 0;
 }
+} // namespace
 
 TEST_CASE("write too large entry") {
 
@@ -241,6 +247,183 @@ TEST_CASE("skip force") {
   ipc_channel_destroy(channel);
 }
 
+TEST_CASE("reserve commit read") {
+  const uint64_t size = ipc_channel_suggest_size(128);
+  std::vector<uint8_t> mem(size);
+  IpcChannelOpenResult channel_result = ipc_channel_create(mem.data(), size);
+  IpcChannel *channel = channel_result.result;
+
+  IpcSlot slot;
+  CHECK(ipc_channel_reserve(channel, sizeof(int), &slot).ipc_status == IPC_OK);
+
+  const int val = 42;
+  memcpy(slot.payload, &val, sizeof(val));
+  CHECK(ipc_channel_commit(channel, &slot).ipc_status == IPC_OK);
+
+  const int res = test_utils::read_data_safe<int>(channel, &DEFAULT_TIMEOUT);
+  CHECK(res == val);
+
+  ipc_channel_destroy(channel);
+}
+
+TEST_CASE("reserve abort") {
+  const uint64_t size = ipc_channel_suggest_size(128);
+  std::vector<uint8_t> mem(size);
+  IpcChannelOpenResult channel_result = ipc_channel_create(mem.data(), size);
+  IpcChannel *channel = channel_result.result;
+
+  IpcSlot slot;
+  CHECK(ipc_channel_reserve(channel, sizeof(int), &slot).ipc_status == IPC_OK);
+  CHECK(ipc_channel_abort(channel, &slot).ipc_status == IPC_OK);
+  CHECK(ipc_channel_commit(channel, &slot).ipc_status ==
+        IPC_ERR_ILLEGAL_STATE);
+
+  IpcEntry entry;
+  CHECK(ipc_channel_try_read(channel, &entry).ipc_status == IPC_EMPTY);
+
+  ipc_channel_destroy(channel);
+}
+
+TEST_CASE("writev") {
+  const uint64_t size = ipc_channel_suggest_size(128);
+  std::vector<uint8_t> mem(size);
+  IpcChannelOpenResult channel_result = ipc_channel_create(mem.data(), size);
+  IpcChannel *channel = channel_result.result;
+
+  int header = 1;
+  int64_t body = 2;
+  struct iovec iov[] = {{&header, sizeof(header)}, {&body, sizeof(body)}};
+  CHECK(ipc_channel_writev(channel, iov, 2).ipc_status == IPC_OK);
+
+  const struct timespec timeout = {.tv_sec = 0, .tv_nsec = 1000000};
+  IpcEntry entry;
+  CHECK(ipc_channel_read(channel, &entry, &timeout).ipc_status == IPC_OK);
+  CHECK(entry.size == sizeof(header) + sizeof(body));
+  CHECK(memcmp(entry.payload, &header, sizeof(header)) == 0);
+  CHECK(memcmp(static_cast<uint8_t *>(entry.payload) + sizeof(header), &body,
+               sizeof(body)) == 0);
+  free(entry.payload);
+
+  ipc_channel_destroy(channel);
+}
+
+TEST_CASE("write batch") {
+  const uint64_t size = ipc_channel_suggest_size(1024);
+  std::vector<uint8_t> mem(size);
+  IpcChannelOpenResult channel_result = ipc_channel_create(mem.data(), size);
+  IpcChannel *channel = channel_result.result;
+
+  int values[8];
+  IpcMessage messages[8];
+  for (int i = 0; i < 8; i++) {
+    values[i] = i * 10;
+    messages[i] = {&values[i], sizeof(int)};
+  }
+
+  const IpcChannelWriteBatchResult result =
+      ipc_channel_write_batch(channel, messages, 8);
+  CHECK(result.ipc_status == IPC_OK);
+  CHECK(result.result == 8);
+
+  const struct timespec timeout = {.tv_sec = 0, .tv_nsec = 1000000};
+  for (int i = 0; i < 8; i++) {
+    IpcEntry entry;
+    CHECK(ipc_channel_read(channel, &entry, &timeout).ipc_status == IPC_OK);
+    CHECK(*static_cast<int *>(entry.payload) == i * 10);
+    free(entry.payload);
+  }
+
+  ipc_channel_destroy(channel);
+}
+
+static void sum_ints(const IpcEntry *entry, void *ctx) {
+  *static_cast<int *>(ctx) += *static_cast<const int *>(entry->payload);
+}
+
+TEST_CASE("drain") {
+  const uint64_t size = ipc_channel_suggest_size(1024);
+  std::vector<uint8_t> mem(size);
+  IpcChannelOpenResult channel_result = ipc_channel_create(mem.data(), size);
+  IpcChannel *channel = channel_result.result;
+
+  const struct timespec timeout = {.tv_sec = 0, .tv_nsec = 1000000};
+  int sum = 0;
+  CHECK(ipc_channel_drain(channel, sum_ints, &sum, 16, &timeout).ipc_status ==
+        IPC_ERR_TIMEOUT);
+
+  for (int i = 1; i <= 5; i++) {
+    CHECK(ipc_channel_write(channel, &i, sizeof(i)).ipc_status == IPC_OK);
+  }
+
+  const IpcChannelDrainResult result =
+      ipc_channel_drain(channel, sum_ints, &sum, 16, &timeout);
+  CHECK(result.ipc_status == IPC_OK);
+  CHECK(result.result == 5);
+  CHECK(sum == 15);
+
+  IpcEntry entry;
+  CHECK(ipc_channel_try_read(channel, &entry).ipc_status == IPC_EMPTY);
+
+  ipc_channel_destroy(channel);
+}
+
+TEST_CASE("acquire release") {
+  const uint64_t size = ipc_channel_suggest_size(128);
+  std::vector<uint8_t> mem(size);
+  IpcChannelOpenResult channel_result = ipc_channel_create(mem.data(), size);
+  IpcChannel *channel = channel_result.result;
+
+  const struct timespec timeout = {.tv_sec = 0, .tv_nsec = 1000000};
+  IpcEntry entry;
+  CHECK(ipc_channel_acquire(channel, &entry, &timeout).ipc_status ==
+        IPC_ERR_TIMEOUT);
+
+  const int val = 7;
+  CHECK(ipc_channel_write(channel, &val, sizeof(val)).ipc_status == IPC_OK);
+  CHECK(ipc_channel_acquire(channel, &entry, &timeout).ipc_status == IPC_OK);
+  CHECK(entry.size == sizeof(val));
+  CHECK(*static_cast<int *>(entry.payload) == val);
+
+  CHECK(ipc_channel_release(channel, &entry).ipc_status == IPC_OK);
+  CHECK(ipc_channel_release(channel, &entry).ipc_status ==
+        IPC_ERR_ILLEGAL_STATE);
+
+  IpcEntry other;
+  CHECK(ipc_channel_try_read(channel, &other).ipc_status == IPC_EMPTY);
+
+  ipc_channel_destroy(channel);
+}
+
+TEST_CASE("connect with options enforces mode") {
+  const uint64_t size = ipc_channel_suggest_size(128);
+  std::vector<uint8_t> mem(size);
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_SPSC, .subscribers = 0};
+  IpcChannelOpenResult channel_result =
+      ipc_channel_create_with_options(mem.data(), size, &options);
+  CHECK(channel_result.ipc_status == IPC_OK);
+
+  const IpcBufferOptions mpmc = {.flags = 0, .subscribers = 0};
+  CHECK(ipc_channel_connect_with_options(mem.data(), &mpmc).ipc_status ==
+        IPC_ERR_ILLEGAL_STATE);
+
+  IpcChannelConnectResult connect_result =
+      ipc_channel_connect_with_options(mem.data(), &options);
+  CHECK(connect_result.ipc_status == IPC_OK);
+
+  const int val = 9;
+  CHECK(ipc_channel_write(channel_result.result, &val, sizeof(val))
+            .ipc_status == IPC_OK);
+  const struct timespec timeout = {.tv_sec = 0, .tv_nsec = 1000000};
+  IpcEntry entry;
+  CHECK(ipc_channel_read(connect_result.result, &entry, &timeout).ipc_status ==
+        IPC_OK);
+  CHECK(*static_cast<int *>(entry.payload) == val);
+  free(entry.payload);
+
+  ipc_channel_destroy(connect_result.result);
+  ipc_channel_destroy(channel_result.result);
+}
+
 TEST_CASE("read timeout") {
   const uint64_t size = ipc_channel_suggest_size(128);
   std::vector<uint8_t> mem(size);
@@ -267,6 +450,246 @@ TEST_CASE("read timeout") {
   ipc_channel_destroy(channel);
 }
 
+TEST_CASE("write timed - times out on a full channel") {
+  const uint64_t size = ipc_channel_suggest_size(128);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *channel = ipc_channel_create(mem.data(), size).result;
+
+  const uint64_t value = 1;
+  const struct timespec timeout = {.tv_sec = 0, .tv_nsec = 1000000};
+  CHECK(ipc_channel_write_timed(channel, &value, sizeof(value), nullptr)
+            .ipc_status == IPC_ERR_INVALID_ARGUMENT);
+  while (ipc_channel_write(channel, &value, sizeof(value)).ipc_status ==
+         IPC_OK) {
+  }
+
+  struct timespec time;
+  CHECK(clock_gettime(CLOCK_MONOTONIC, &time) == 0);
+  const uint64_t before_ns = ipc_timespec_to_nanos(&time);
+
+  CHECK(ipc_channel_write_timed(channel, &value, sizeof(value), &timeout)
+            .ipc_status == IPC_ERR_TIMEOUT);
+
+  CHECK(clock_gettime(CLOCK_MONOTONIC, &time) == 0);
+  CHECK(ipc_timespec_to_nanos(&time) - before_ns >=
+        ipc_timespec_to_nanos(&timeout));
+
+  // with room it behaves like ipc_channel_write
+  IpcEntry entry;
+  CHECK(ipc_channel_read(channel, &entry, &DEFAULT_TIMEOUT).ipc_status ==
+        IPC_OK);
+  free(entry.payload);
+  CHECK(ipc_channel_write_timed(channel, &value, sizeof(value), &timeout)
+            .ipc_status == IPC_OK);
+
+  ipc_channel_destroy(channel);
+}
+
+TEST_CASE("until - absolute deadlines") {
+  const uint64_t size = ipc_channel_suggest_size(128);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *channel = ipc_channel_create(mem.data(), size).result;
+
+  IpcEntry entry;
+  const struct timespec invalid = {.tv_sec = 0, .tv_nsec = -1};
+  CHECK(ipc_channel_read_until(channel, &entry, nullptr).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+  CHECK(ipc_channel_read_until(channel, &entry, &invalid).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+  uint64_t mask = 0;
+  CHECK(ipc_channel_select_until(&channel, 1, nullptr, &mask).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+  CHECK(ipc_channel_select_until(&channel, 1, &invalid, &mask).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+
+  // a deadline in the past still gets one attempt
+  const struct timespec past = {.tv_sec = 0, .tv_nsec = 0};
+  CHECK(ipc_channel_read_until(channel, &entry, &past).ipc_status ==
+        IPC_ERR_TIMEOUT);
+  CHECK(ipc_channel_select_until(&channel, 1, &past, &mask).ipc_status ==
+        IPC_ERR_TIMEOUT);
+  const int val = 5;
+  CHECK(ipc_channel_write(channel, &val, sizeof(val)).ipc_status == IPC_OK);
+  CHECK(ipc_channel_select_until(&channel, 1, &past, &mask).result == 1);
+  CHECK(mask == 1);
+  CHECK(ipc_channel_read_until(channel, &entry, &past).ipc_status == IPC_OK);
+  CHECK(*(int *)entry.payload == val);
+  free(entry.payload);
+
+  struct timespec time;
+  CHECK(clock_gettime(CLOCK_MONOTONIC, &time) == 0);
+  const uint64_t deadline_ns = ipc_timespec_to_nanos(&time) + 1000000;
+  const struct timespec deadline = {
+      .tv_sec = (time_t)(deadline_ns / 1000000000),
+      .tv_nsec = (long)(deadline_ns % 1000000000)};
+
+  // one deadline shared by consecutive calls
+  int sum = 0;
+  const IpcChannelReadResult read =
+      ipc_channel_read_until(channel, &entry, &deadline);
+  CHECK(read.ipc_status == IPC_ERR_TIMEOUT);
+  CHECK(read.error.body.timeout_used.tv_sec == deadline.tv_sec);
+  CHECK(read.error.body.timeout_used.tv_nsec == deadline.tv_nsec);
+  CHECK(ipc_channel_acquire_until(channel, &entry, &deadline).ipc_status ==
+        IPC_ERR_TIMEOUT);
+  CHECK(ipc_channel_drain_until(channel, sum_ints, &sum, 16, &deadline)
+            .ipc_status == IPC_ERR_TIMEOUT);
+  const IpcChannelSelectResult selected =
+      ipc_channel_select_until(&channel, 1, &deadline, &mask);
+  CHECK(selected.ipc_status == IPC_ERR_TIMEOUT);
+  CHECK(selected.error.body.timeout_used.tv_nsec == deadline.tv_nsec);
+  CHECK(mask == 0);
+  CHECK(clock_gettime(CLOCK_MONOTONIC, &time) == 0);
+  CHECK(ipc_timespec_to_nanos(&time) >= deadline_ns);
+
+  while (ipc_channel_write(channel, &val, sizeof(val)).ipc_status == IPC_OK) {
+  }
+  CHECK(ipc_channel_write_until(channel, &val, sizeof(val), &deadline)
+            .ipc_status == IPC_ERR_TIMEOUT);
+
+  ipc_channel_destroy(channel);
+}
+
+TEST_CASE("read into - caller owned buffer") {
+  const uint64_t size = ipc_channel_suggest_size(128);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *channel = ipc_channel_create(mem.data(), size).result;
+
+  char buf[8];
+  size_t len = 0;
+  CHECK(ipc_channel_read_into(channel, nullptr, sizeof(buf), &len,
+                              &DEFAULT_TIMEOUT)
+            .ipc_status == IPC_ERR_INVALID_ARGUMENT);
+  CHECK(ipc_channel_read_into(channel, buf, sizeof(buf), nullptr,
+                              &DEFAULT_TIMEOUT)
+            .ipc_status == IPC_ERR_INVALID_ARGUMENT);
+
+  const struct timespec timeout = {.tv_sec = 0, .tv_nsec = 1000000};
+  CHECK(ipc_channel_read_into(channel, buf, sizeof(buf), &len, &timeout)
+            .ipc_status == IPC_ERR_TIMEOUT);
+
+  const char msg[] = "larger than eight";
+  CHECK(ipc_channel_write(channel, msg, sizeof(msg)).ipc_status == IPC_OK);
+  const IpcChannelReadIntoResult too_small =
+      ipc_channel_read_into(channel, buf, sizeof(buf), &len, &timeout);
+  CHECK(too_small.ipc_status == IPC_ERR_TOO_SMALL);
+  CHECK(too_small.error.body.required_size == sizeof(msg));
+
+  // the entry stays until a buffer that fits comes along
+  char large[32];
+  CHECK(ipc_channel_read_into(channel, large, sizeof(large), &len, &timeout)
+            .ipc_status == IPC_OK);
+  CHECK(len == sizeof(msg));
+  CHECK(std::memcmp(large, msg, sizeof(msg)) == 0);
+
+  const int val = 7;
+  CHECK(ipc_channel_write(channel, &val, sizeof(val)).ipc_status == IPC_OK);
+  CHECK(ipc_channel_read_into(channel, buf, sizeof(buf), &len, &timeout)
+            .ipc_status == IPC_OK);
+  CHECK(len == sizeof(val));
+  int read_val;
+  memcpy(&read_val, buf, sizeof(read_val));
+  CHECK(read_val == val);
+
+  ipc_channel_destroy(channel);
+}
+
+TEST_CASE("payload pool - recycles read payloads") {
+  const uint64_t size = ipc_channel_suggest_size(512);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *channel = ipc_channel_create(mem.data(), size).result;
+
+  CHECK(ipc_channel_enable_payload_pool(nullptr, 4).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+  CHECK(ipc_channel_enable_payload_pool(channel, 0).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+  CHECK(ipc_channel_enable_payload_pool(channel, 4).ipc_status == IPC_OK);
+  CHECK(ipc_channel_enable_payload_pool(channel, 4).ipc_status ==
+        IPC_ERR_ILLEGAL_STATE);
+
+  for (int i = 0; i < 10; i++) {
+    CHECK(ipc_channel_write(channel, &i, sizeof(i)).ipc_status == IPC_OK);
+    IpcEntry entry;
+    CHECK(ipc_channel_read(channel, &entry, &DEFAULT_TIMEOUT).ipc_status ==
+          IPC_OK);
+    CHECK(entry.size == sizeof(i));
+    CHECK(*(int *)entry.payload == i);
+    ipc_entry_release(&entry);
+    CHECK(entry.payload == nullptr);
+  }
+
+  IpcPayloadPoolStats stats = ipc_channel_get_payload_pool_stats(channel);
+  CHECK(stats.misses == 1);
+  CHECK(stats.hits == 9);
+
+  // another size class, then the small one again
+  uint8_t large[200] = {1};
+  CHECK(ipc_channel_write(channel, large, sizeof(large)).ipc_status == IPC_OK);
+  IpcEntry entry;
+  CHECK(ipc_channel_try_read(channel, &entry).ipc_status == IPC_OK);
+  CHECK(entry.size == sizeof(large));
+  CHECK(std::memcmp(entry.payload, large, sizeof(large)) == 0);
+  const int val = 3;
+  CHECK(ipc_channel_write(channel, &val, sizeof(val)).ipc_status == IPC_OK);
+  IpcEntry small;
+  CHECK(ipc_channel_try_read(channel, &small).ipc_status == IPC_OK);
+  stats = ipc_channel_get_payload_pool_stats(channel);
+  CHECK(stats.misses == 2);
+  CHECK(stats.hits == 10);
+
+  ipc_channel_destroy(channel);
+  // the pool outlives the handle until its last entry is back
+  ipc_entry_release(&entry);
+  ipc_entry_release(&small);
+}
+
+TEST_CASE("wait strategy - invalid arguments") {
+  const uint64_t size = ipc_channel_suggest_size(128);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *channel = ipc_channel_create(mem.data(), size).result;
+
+  const IpcWaitStrategy spin = {.kind = IPC_WAIT_BUSY_SPIN, .spin_limit = 0};
+  CHECK(ipc_channel_set_wait_strategy(nullptr, &spin).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+  CHECK(ipc_channel_set_wait_strategy(channel, nullptr).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+  const IpcWaitStrategy unknown = {.kind = (IpcWaitKind)42, .spin_limit = 0};
+  CHECK(ipc_channel_set_wait_strategy(channel, &unknown).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+
+  ipc_channel_destroy(channel);
+}
+
+TEST_CASE("wait strategy - every kind honours the timeout") {
+  for (const IpcWaitKind kind : {IPC_WAIT_FUTEX, IPC_WAIT_BUSY_SPIN,
+                                 IPC_WAIT_SPIN_YIELD, IPC_WAIT_SPIN_FUTEX}) {
+    const uint64_t size = ipc_channel_suggest_size(128);
+    std::vector<uint8_t> mem(size);
+    IpcChannel *channel = ipc_channel_create(mem.data(), size).result;
+    const IpcWaitStrategy strategy = {.kind = kind, .spin_limit = 100};
+    CHECK(ipc_channel_set_wait_strategy(channel, &strategy).ipc_status ==
+          IPC_OK);
+
+    const struct timespec timeout = {.tv_sec = 0, .tv_nsec = 1000000};
+    struct timespec time;
+    CHECK(clock_gettime(CLOCK_MONOTONIC, &time) == 0);
+    const uint64_t before_ns = ipc_timespec_to_nanos(&time);
+
+    IpcEntry entry;
+    CHECK(ipc_channel_read(channel, &entry, &timeout).ipc_status ==
+          IPC_ERR_TIMEOUT);
+    CHECK(clock_gettime(CLOCK_MONOTONIC, &time) == 0);
+    CHECK(ipc_timespec_to_nanos(&time) - before_ns >=
+          ipc_timespec_to_nanos(&timeout));
+
+    const int val = 3;
+    CHECK(ipc_channel_write(channel, &val, sizeof(val)).ipc_status == IPC_OK);
+    CHECK(test_utils::read_data<int>(channel, &timeout) == val);
+
+    ipc_channel_destroy(channel);
+  }
+}
+
 TEST_CASE("channel data - different sizes") {
   struct timespec timeout = {0, 100000000}; // 100ms
   const uint64_t size = ipc_channel_suggest_size(2048);
@@ -317,3 +740,194 @@ TEST_CASE("channel data - different sizes") {
 
   ipc_channel_destroy(channel);
 }
+
+TEST_CASE("broadcast channel - subscribers each receive every message") {
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_BROADCAST,
+                                    .subscribers = 2};
+  const uint64_t size = ipc_channel_suggest_size_with_options(256, &options);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *writer =
+      ipc_channel_create_with_options(mem.data(), size, &options).result;
+  REQUIRE(writer != nullptr);
+
+  IpcChannel *first = ipc_channel_connect(mem.data()).result;
+  IpcChannel *second = ipc_channel_connect(mem.data()).result;
+  CHECK(ipc_channel_subscribe(first).ipc_status == IPC_OK);
+  CHECK(ipc_channel_subscribe(second).ipc_status == IPC_OK);
+  CHECK(ipc_channel_subscribe(writer).ipc_status == IPC_ERR_ILLEGAL_STATE);
+
+  const int val = 5;
+  CHECK(ipc_channel_write(writer, &val, sizeof(val)).ipc_status == IPC_OK);
+
+  const struct timespec timeout = {.tv_sec = 0, .tv_nsec = 1000000};
+  CHECK(test_utils::read_data<int>(first, &timeout) == val);
+  CHECK(test_utils::read_data<int>(second, &timeout) == val);
+
+  // destroying a subscriber frees its slot for the next one
+  ipc_channel_destroy(second);
+  CHECK(ipc_channel_subscribe(writer).ipc_status == IPC_OK);
+  CHECK(ipc_channel_unsubscribe(writer).ipc_status == IPC_OK);
+
+  ipc_channel_destroy(first);
+  ipc_channel_destroy(writer);
+}
+
+TEST_CASE("broadcast channel - consumer groups") {
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_BROADCAST,
+                                    .subscribers = 2};
+  const uint64_t size = ipc_channel_suggest_size_with_options(256, &options);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *writer =
+      ipc_channel_create_with_options(mem.data(), size, &options).result;
+  REQUIRE(writer != nullptr);
+
+  IpcChannel *worker = ipc_channel_connect(mem.data()).result;
+  IpcChannel *audit = ipc_channel_connect(mem.data()).result;
+  CHECK(ipc_channel_join_group(worker, "workers").ipc_status == IPC_OK);
+  CHECK(ipc_channel_join_group(audit, "audit").ipc_status == IPC_OK);
+  CHECK(ipc_channel_join_group(nullptr, "x").ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+
+  const int val = 7;
+  CHECK(ipc_channel_write(writer, &val, sizeof(val)).ipc_status == IPC_OK);
+
+  const struct timespec timeout = {.tv_sec = 0, .tv_nsec = 1000000};
+  CHECK(test_utils::read_data<int>(worker, &timeout) == val);
+  CHECK(test_utils::read_data<int>(audit, &timeout) == val);
+
+  ipc_channel_destroy(audit);
+  CHECK(ipc_channel_join_group(writer, "workers").ipc_status == IPC_OK);
+  CHECK(ipc_channel_unsubscribe(writer).ipc_status == IPC_OK);
+
+  ipc_channel_destroy(worker);
+  ipc_channel_destroy(writer);
+}
+
+TEST_CASE("readiness fd - one owner per channel") {
+  const uint64_t size = ipc_channel_suggest_size(256);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *owner = ipc_channel_create(mem.data(), size).result;
+  IpcChannel *other = ipc_channel_connect(mem.data()).result;
+
+  CHECK(ipc_channel_get_readiness_fd(nullptr).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+  CHECK(ipc_channel_arm_readiness(nullptr).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+  CHECK(ipc_channel_arm_readiness(owner).ipc_status == IPC_ERR_ILLEGAL_STATE);
+
+  const IpcChannelReadinessFdResult fd = ipc_channel_get_readiness_fd(owner);
+  REQUIRE(fd.ipc_status == IPC_OK);
+  CHECK(fd.result >= 0);
+  CHECK(ipc_channel_get_readiness_fd(owner).result == fd.result);
+  CHECK(ipc_channel_get_readiness_fd(other).ipc_status ==
+        IPC_ERR_ILLEGAL_STATE);
+  CHECK(ipc_channel_arm_readiness(other).ipc_status == IPC_ERR_ILLEGAL_STATE);
+
+  // destroying the owner hands ownership to the next handle asking
+  ipc_channel_destroy(owner);
+  CHECK(ipc_channel_get_readiness_fd(other).ipc_status == IPC_OK);
+  ipc_channel_destroy(other);
+}
+
+TEST_CASE("readiness fd - signalled once per arming") {
+  const uint64_t size = ipc_channel_suggest_size(256);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *consumer = ipc_channel_create(mem.data(), size).result;
+  IpcChannel *producer = ipc_channel_connect(mem.data()).result;
+  const int fd = ipc_channel_get_readiness_fd(consumer).result;
+  REQUIRE(fd >= 0);
+
+  // unarmed, a write leaves the descriptor alone
+  const int val = 5;
+  CHECK(ipc_channel_write(producer, &val, sizeof(val)).ipc_status == IPC_OK);
+  CHECK(!is_readable(fd));
+
+  // entries already waiting: arming reports them instead of arming
+  const IpcChannelArmReadinessResult raced = ipc_channel_arm_readiness(consumer);
+  CHECK(raced.ipc_status == IPC_OK);
+  CHECK(raced.result);
+  CHECK(test_utils::read_data<int>(consumer, &DEFAULT_TIMEOUT) == val);
+
+  const IpcChannelArmReadinessResult armed = ipc_channel_arm_readiness(consumer);
+  CHECK(armed.ipc_status == IPC_OK);
+  CHECK(!armed.result);
+  CHECK(!is_readable(fd));
+
+  // the other handle signals through its own copy of the descriptor
+  CHECK(ipc_channel_write(producer, &val, sizeof(val)).ipc_status == IPC_OK);
+  CHECK(is_readable(fd));
+  CHECK(ipc_channel_write(producer, &val, sizeof(val)).ipc_status == IPC_OK);
+  CHECK(test_utils::read_data<int>(consumer, &DEFAULT_TIMEOUT) == val);
+  CHECK(test_utils::read_data<int>(consumer, &DEFAULT_TIMEOUT) == val);
+
+  // re-arming resets it
+  CHECK(!ipc_channel_arm_readiness(consumer).result);
+  CHECK(!is_readable(fd));
+
+  ipc_channel_destroy(producer);
+  ipc_channel_destroy(consumer);
+}
+
+TEST_CASE("select - invalid arguments") {
+  const uint64_t size = ipc_channel_suggest_size(256);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *channel = ipc_channel_create(mem.data(), size).result;
+  IpcChannel *channels[] = {channel, nullptr};
+  uint64_t mask = 0;
+
+  CHECK(ipc_channel_select(nullptr, 1, &DEFAULT_TIMEOUT, &mask).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+  CHECK(ipc_channel_select(channels, 1, &DEFAULT_TIMEOUT, nullptr)
+            .ipc_status == IPC_ERR_INVALID_ARGUMENT);
+  CHECK(ipc_channel_select(channels, 0, &DEFAULT_TIMEOUT, &mask).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+  CHECK(ipc_channel_select(channels, IPC_CHANNEL_SELECT_MAX + 1,
+                           &DEFAULT_TIMEOUT, &mask)
+            .ipc_status == IPC_ERR_INVALID_ARGUMENT);
+  CHECK(ipc_channel_select(channels, 1, nullptr, &mask).ipc_status ==
+        IPC_ERR_INVALID_ARGUMENT);
+
+  const IpcChannelSelectResult null_channel =
+      ipc_channel_select(channels, 2, &DEFAULT_TIMEOUT, &mask);
+  CHECK(null_channel.ipc_status == IPC_ERR_INVALID_ARGUMENT);
+  CHECK(null_channel.error.body.index == 1);
+
+  ipc_channel_destroy(channel);
+}
+
+TEST_CASE("select - reports every readable channel") {
+  constexpr size_t count = 3;
+  const uint64_t size = ipc_channel_suggest_size(256);
+  std::vector<std::vector<uint8_t>> mems(count, std::vector<uint8_t>(size));
+  IpcChannel *channels[count];
+  for (size_t i = 0; i < count; i++) {
+    channels[i] = ipc_channel_create(mems[i].data(), size).result;
+  }
+
+  uint64_t mask = 0xff;
+  const struct timespec timeout = {.tv_sec = 0, .tv_nsec = 10000000};
+  CHECK(ipc_channel_select(channels, count, &timeout, &mask).ipc_status ==
+        IPC_ERR_TIMEOUT);
+  CHECK(mask == 0);
+
+  const int val = 3;
+  CHECK(ipc_channel_write(channels[0], &val, sizeof(val)).ipc_status ==
+        IPC_OK);
+  CHECK(ipc_channel_write(channels[2], &val, sizeof(val)).ipc_status ==
+        IPC_OK);
+
+  const IpcChannelSelectResult ready =
+      ipc_channel_select(channels, count, &timeout, &mask);
+  CHECK(ready.ipc_status == IPC_OK);
+  CHECK(ready.result == 2);
+  CHECK(mask == 0b101);
+
+  // nothing was consumed
+  CHECK(test_utils::read_data<int>(channels[2], &DEFAULT_TIMEOUT) == val);
+  CHECK(ipc_channel_select(channels, count, &timeout, &mask).result == 1);
+  CHECK(mask == 0b001);
+
+  for (IpcChannel *channel : channels) {
+    ipc_channel_destroy(channel);
+  }
+}
@@ -8,7 +8,12 @@
 #include "test_utils.h"
 #include "unsafe_collector.hpp"
 #include <atomic>
+#include <mutex>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
 #include <thread>
+#include <unistd.h>
 #include <unordered_set>
 #include <vector>
 
@@ -260,3 +265,481 @@ TEST_CASE("blocks reader until writer writes") {
 
   ipc_channel_destroy(channel);
 }
+
+TEST_CASE("timed writer blocks until reader frees space") {
+  const uint64_t size = ipc_channel_suggest_size(test_utils::SMALL_BUFFER_SIZE);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *channel = ipc_channel_create(mem.data(), size).result;
+
+  const size_t total = test_utils::LARGE_COUNT / 5;
+  std::atomic<bool> writes_ok{true};
+  std::thread writer([&]() {
+    const struct timespec timeout = {.tv_sec = 2000, .tv_nsec = 0};
+    for (size_t i = 0; i < total; i++) {
+      if (ipc_channel_write_timed(channel, &i, sizeof(i), &timeout)
+              .ipc_status != IPC_OK) {
+        writes_ok.store(false);
+      }
+    }
+  });
+
+  // a slow start lets the writer fill the ring and park on the space word
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  bool in_order = true;
+  const struct timespec timeout = {.tv_sec = 2000, .tv_nsec = 0};
+  for (size_t i = 0; i < total; i++) {
+    IpcEntry entry;
+    REQUIRE(ipc_channel_read(channel, &entry, &timeout).ipc_status == IPC_OK);
+    size_t value;
+    memcpy(&value, entry.payload, sizeof(value));
+    in_order = in_order && value == i;
+    free(entry.payload);
+  }
+  writer.join();
+
+  CHECK(writes_ok.load());
+  CHECK(in_order);
+  ipc_channel_destroy(channel);
+}
+
+TEST_CASE("spinning readers receive every message") {
+  for (const IpcWaitKind kind :
+       {IPC_WAIT_BUSY_SPIN, IPC_WAIT_SPIN_YIELD, IPC_WAIT_SPIN_FUTEX}) {
+    const uint64_t size =
+        ipc_channel_suggest_size(test_utils::SMALL_BUFFER_SIZE);
+    std::vector<uint8_t> mem(size);
+    IpcChannel *channel = ipc_channel_create(mem.data(), size).result;
+    const IpcWaitStrategy strategy = {.kind = kind, .spin_limit = 64};
+    REQUIRE(ipc_channel_set_wait_strategy(channel, &strategy).ipc_status ==
+            IPC_OK);
+
+    const size_t total = test_utils::LARGE_COUNT / 50;
+    std::thread writer([&]() {
+      const struct timespec timeout = {.tv_sec = 2000, .tv_nsec = 0};
+      for (size_t i = 0; i < total; i++) {
+        ipc_channel_write_timed(channel, &i, sizeof(i), &timeout);
+      }
+    });
+
+    bool in_order = true;
+    const struct timespec timeout = {.tv_sec = 2000, .tv_nsec = 0};
+    for (size_t i = 0; i < total; i++) {
+      IpcEntry entry;
+      REQUIRE(ipc_channel_read(channel, &entry, &timeout).ipc_status ==
+              IPC_OK);
+      size_t value;
+      memcpy(&value, entry.payload, sizeof(value));
+      in_order = in_order && value == i;
+      free(entry.payload);
+    }
+    writer.join();
+
+    CHECK(in_order);
+    ipc_channel_destroy(channel);
+  }
+}
+
+TEST_CASE("ping pong never loses a wakeup") {
+  const uint64_t size = ipc_channel_suggest_size(test_utils::SMALL_BUFFER_SIZE);
+  std::vector<uint8_t> ping_mem(size);
+  std::vector<uint8_t> pong_mem(size);
+  IpcChannel *ping = ipc_channel_create(ping_mem.data(), size).result;
+  IpcChannel *pong = ipc_channel_create(pong_mem.data(), size).result;
+
+  // every round trip parks both sides, a missed wakeup shows up as a timeout
+  const size_t rounds = test_utils::LARGE_COUNT / 100;
+  const struct timespec timeout = {.tv_sec = 30, .tv_nsec = 0};
+  std::atomic<bool> echo_ok{true};
+  std::thread echo([&]() {
+    for (size_t i = 0; i < rounds; i++) {
+      IpcEntry entry;
+      if (ipc_channel_read(ping, &entry, &timeout).ipc_status != IPC_OK) {
+        echo_ok.store(false);
+        return;
+      }
+      ipc_channel_write(pong, entry.payload, entry.size);
+      free(entry.payload);
+    }
+  });
+
+  bool in_order = true;
+  for (size_t i = 0; i < rounds; i++) {
+    REQUIRE(ipc_channel_write(ping, &i, sizeof(i)).ipc_status == IPC_OK);
+    IpcEntry entry;
+    REQUIRE(ipc_channel_read(pong, &entry, &timeout).ipc_status == IPC_OK);
+    size_t value;
+    memcpy(&value, entry.payload, sizeof(value));
+    in_order = in_order && value == i;
+    free(entry.payload);
+  }
+  echo.join();
+
+  CHECK(echo_ok.load());
+  CHECK(in_order);
+  ipc_channel_destroy(ping);
+  ipc_channel_destroy(pong);
+}
+
+TEST_CASE("parked readers share batches and single writes") {
+  const uint64_t size = ipc_channel_suggest_size(test_utils::SMALL_BUFFER_SIZE);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *channel = ipc_channel_create(mem.data(), size).result;
+
+  // a reader is woken per entry and passes any backlog on, a missed hand-off
+  // leaves an entry behind until the timeout
+  constexpr size_t readers = 4;
+  constexpr size_t batch = 4;
+  const size_t total = test_utils::LARGE_COUNT / 10;
+  std::atomic<size_t> consumed{0};
+  std::atomic<size_t> sum{0};
+  std::atomic<bool> reads_ok{true};
+  std::vector<std::thread> threads;
+  for (size_t r = 0; r < readers; r++) {
+    threads.emplace_back([&]() {
+      const struct timespec timeout = {.tv_sec = 30, .tv_nsec = 0};
+      while (consumed.load() < total) {
+        IpcEntry entry;
+        const IpcChannelReadResult read =
+            ipc_channel_read(channel, &entry, &timeout);
+        if (read.ipc_status == IPC_ERR_TIMEOUT && consumed.load() >= total) {
+          return;
+        }
+        if (read.ipc_status != IPC_OK) {
+          reads_ok.store(false);
+          return;
+        }
+        size_t value;
+        memcpy(&value, entry.payload, sizeof(value));
+        free(entry.payload);
+        sum.fetch_add(value);
+        if (consumed.fetch_add(1) + 1 == total) {
+          // unblock the readers still parked
+          for (size_t i = 0; i < readers; i++) {
+            const size_t stop = 0;
+            ipc_channel_write(channel, &stop, sizeof(stop));
+          }
+        }
+      }
+    });
+  }
+
+  for (size_t i = 0; i < total;) {
+    size_t values[batch];
+    IpcMessage messages[batch];
+    size_t count = 0;
+    // alternate between batches and single writes
+    const size_t step = (i / batch) % 2 == 0 ? batch : 1;
+    for (; count < step && i + count < total; count++) {
+      values[count] = i + count;
+      messages[count] = {.data = &values[count], .size = sizeof(size_t)};
+    }
+    const IpcChannelWriteBatchResult written =
+        ipc_channel_write_batch(channel, messages, count);
+    if (written.ipc_status == IPC_OK) {
+      // only the leading messages that fit are written
+      i += written.result;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  CHECK(reads_ok.load());
+  CHECK(consumed.load() >= total);
+  CHECK(sum.load() == total * (total - 1) / 2);
+  ipc_channel_destroy(channel);
+}
+
+TEST_CASE("event loop consumer waits on the readiness fd") {
+  const uint64_t size = ipc_channel_suggest_size(test_utils::SMALL_BUFFER_SIZE);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *consumer = ipc_channel_create(mem.data(), size).result;
+  IpcChannel *producer = ipc_channel_connect(mem.data()).result;
+  const int fd = ipc_channel_get_readiness_fd(consumer).result;
+  REQUIRE(fd >= 0);
+
+  const size_t total = test_utils::LARGE_COUNT / 10;
+  std::thread writer([&]() {
+    const struct timespec timeout = {.tv_sec = 30, .tv_nsec = 0};
+    for (size_t i = 0; i < total; i++) {
+      ipc_channel_write_timed(producer, &i, sizeof(i), &timeout);
+      if (i % 64 == 0) {
+        // let the consumer run dry and arm
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  size_t received = 0;
+  bool in_order = true;
+  bool signalled = true;
+  while (received < total && signalled) {
+    IpcEntry entry;
+    while (ipc_channel_try_read(consumer, &entry).ipc_status == IPC_OK) {
+      size_t value;
+      memcpy(&value, entry.payload, sizeof(value));
+      in_order = in_order && value == received;
+      received++;
+      free(entry.payload);
+    }
+
+    if (ipc_channel_arm_readiness(consumer).result) {
+      continue;
+    }
+    // a missed signal shows up as a poll timeout
+    struct pollfd pfd = {.fd = fd, .events = POLLIN, .revents = 0};
+    signalled = received == total || poll(&pfd, 1, 30000) == 1;
+  }
+  writer.join();
+
+  CHECK(signalled);
+  CHECK(received == total);
+  CHECK(in_order);
+  ipc_channel_destroy(producer);
+  ipc_channel_destroy(consumer);
+}
+
+TEST_CASE("unreachable readiness fd falls back to the futex") {
+  const uint64_t size = ipc_channel_suggest_size(test_utils::SMALL_BUFFER_SIZE);
+  void *mem = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  REQUIRE(mem != MAP_FAILED);
+  IpcChannel *reader = ipc_channel_create(mem, size).result;
+  IpcChannel *producer = ipc_channel_connect(mem).result;
+
+  // the owner is another process that closed its descriptor, copying it
+  // fails like it would without ptrace access to the owner
+  int to_parent[2];
+  int to_child[2];
+  REQUIRE(pipe(to_parent) == 0);
+  REQUIRE(pipe(to_child) == 0);
+  const pid_t child = fork();
+  REQUIRE(child >= 0);
+  if (child == 0) {
+    IpcChannel *owner = ipc_channel_connect(mem).result;
+    const int fd = ipc_channel_get_readiness_fd(owner).result;
+    bool ok = fd >= 0 && !ipc_channel_arm_readiness(owner).result;
+    close(fd);
+    char byte = 0;
+    ok = write(to_parent[1], &byte, 1) == 1 && ok;
+    ok = read(to_child[0], &byte, 1) == 1 && ok;
+
+    // the owner learns about it
+    const IpcChannelArmReadinessResult armed = ipc_channel_arm_readiness(owner);
+    ok = ok && armed.ipc_status == IPC_ERR_SYSTEM &&
+         armed.error.body.sys_errno == EBADF;
+    ok = ok && ipc_channel_get_readiness_fd(owner).ipc_status == IPC_ERR_SYSTEM;
+    _exit(ok ? 0 : 1);
+  }
+
+  char byte;
+  REQUIRE(read(to_parent[0], &byte, 1) == 1);
+  std::atomic<bool> reader_ready{false};
+  std::thread writer([&]() {
+    while (!reader_ready.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    test_utils::write_data(producer, 42);
+  });
+
+  // the wakeup must reach the parked reader, not the unreachable descriptor
+  const struct timespec timeout = {.tv_sec = 10, .tv_nsec = 0};
+  IpcEntry entry;
+  reader_ready.store(true, std::memory_order_release);
+  const auto start = std::chrono::steady_clock::now();
+  const IpcChannelReadResult read_result =
+      ipc_channel_read(reader, &entry, &timeout);
+  const auto waited = std::chrono::steady_clock::now() - start;
+  writer.join();
+  CHECK(read_result.ipc_status == IPC_OK);
+  CHECK(waited < std::chrono::seconds(5));
+  if (read_result.ipc_status == IPC_OK) {
+    free(entry.payload);
+  }
+
+  REQUIRE(write(to_child[1], &byte, 1) == 1);
+  int status = 0;
+  REQUIRE(waitpid(child, &status, 0) == child);
+  CHECK(WIFEXITED(status));
+  CHECK(WEXITSTATUS(status) == 0);
+
+  for (const int fd : {to_parent[0], to_parent[1], to_child[0], to_child[1]}) {
+    close(fd);
+  }
+  ipc_channel_destroy(producer);
+  ipc_channel_destroy(reader);
+  munmap(mem, size);
+}
+
+TEST_CASE("one thread serves many channels through select") {
+  constexpr size_t count = 8;
+  const uint64_t size = ipc_channel_suggest_size(test_utils::SMALL_BUFFER_SIZE);
+  std::vector<std::vector<uint8_t>> mems(count, std::vector<uint8_t>(size));
+  IpcChannel *channels[count];
+  for (size_t i = 0; i < count; i++) {
+    channels[i] = ipc_channel_create(mems[i].data(), size).result;
+  }
+
+  const size_t total = test_utils::LARGE_COUNT / 10;
+  std::thread writer([&]() {
+    const struct timespec timeout = {.tv_sec = 30, .tv_nsec = 0};
+    for (size_t i = 0; i < total; i++) {
+      // a stride coprime to count visits every channel
+      ipc_channel_write_timed(channels[(i * 3) % count], &i, sizeof(i),
+                              &timeout);
+      if (i % 32 == 0) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  size_t received = 0;
+  size_t sum = 0;
+  bool selected = true;
+  const struct timespec timeout = {.tv_sec = 30, .tv_nsec = 0};
+  while (received < total && selected) {
+    uint64_t mask = 0;
+    // a missed wakeup shows up as a timeout
+    selected = ipc_channel_select(channels, count, &timeout, &mask)
+                   .ipc_status == IPC_OK;
+    for (size_t i = 0; i < count; i++) {
+      if ((mask & (1ULL << i)) == 0) {
+        continue;
+      }
+      IpcEntry entry;
+      while (ipc_channel_try_read(channels[i], &entry).ipc_status == IPC_OK) {
+        size_t value;
+        memcpy(&value, entry.payload, sizeof(value));
+        sum += value;
+        received++;
+        free(entry.payload);
+      }
+    }
+  }
+  writer.join();
+
+  CHECK(selected);
+  CHECK(received == total);
+  CHECK(sum == total * (total - 1) / 2);
+  for (IpcChannel *channel : channels) {
+    ipc_channel_destroy(channel);
+  }
+}
+
+TEST_CASE("select caller does not take a parked reader's wakeup") {
+  const uint64_t size = ipc_channel_suggest_size(test_utils::SMALL_BUFFER_SIZE);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *channel = ipc_channel_create(mem.data(), size).result;
+  IpcChannel *watched = ipc_channel_connect(mem.data()).result;
+
+  // the select caller parks first, a wake-one would go to it and leave the
+  // reader asleep until its timeout
+  std::thread selector([&]() {
+    const struct timespec timeout = {.tv_sec = 3, .tv_nsec = 0};
+    uint64_t mask;
+    ipc_channel_select(&watched, 1, &timeout, &mask);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  IpcChannelReadResult read_result;
+  std::chrono::steady_clock::duration waited{};
+  IpcEntry entry;
+  std::thread reader([&]() {
+    const struct timespec timeout = {.tv_sec = 10, .tv_nsec = 0};
+    const auto start = std::chrono::steady_clock::now();
+    read_result = ipc_channel_read(channel, &entry, &timeout);
+    waited = std::chrono::steady_clock::now() - start;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  test_utils::write_data(channel, 42);
+  reader.join();
+  selector.join();
+
+  REQUIRE(read_result.ipc_status == IPC_OK);
+  free(entry.payload);
+  CHECK(waited < std::chrono::seconds(2));
+
+  ipc_channel_destroy(watched);
+  ipc_channel_destroy(channel);
+}
+
+TEST_CASE("pooled payloads released on another thread") {
+  const uint64_t size = ipc_channel_suggest_size(test_utils::SMALL_BUFFER_SIZE);
+  std::vector<uint8_t> mem(size);
+  IpcChannel *channel = ipc_channel_create(mem.data(), size).result;
+  REQUIRE(ipc_channel_enable_payload_pool(channel, 16).ipc_status == IPC_OK);
+
+  const size_t total = test_utils::LARGE_COUNT / 50;
+  std::thread writer([&]() {
+    const struct timespec timeout = {.tv_sec = 2000, .tv_nsec = 0};
+    for (size_t i = 0; i < total; i++) {
+      ipc_channel_write_timed(channel, &i, sizeof(i), &timeout);
+    }
+  });
+
+  std::mutex lock;
+  std::vector<IpcEntry> handed_off;
+  std::atomic<bool> reading{true};
+  std::atomic<size_t> released{0};
+  size_t sum = 0;
+  std::thread releaser([&]() {
+    std::vector<IpcEntry> batch;
+    while (reading.load()) {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        batch.swap(handed_off);
+      }
+      for (IpcEntry &entry : batch) {
+        size_t value;
+        memcpy(&value, entry.payload, sizeof(value));
+        sum += value;
+        ipc_entry_release(&entry);
+        released.fetch_add(1);
+      }
+      if (batch.empty()) {
+        std::this_thread::yield();
+      }
+      batch.clear();
+    }
+  });
+
+  const struct timespec timeout = {.tv_sec = 2000, .tv_nsec = 0};
+  for (size_t i = 0; i < total; i++) {
+    IpcEntry entry;
+    REQUIRE(ipc_channel_read(channel, &entry, &timeout).ipc_status == IPC_OK);
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      handed_off.push_back(entry);
+    }
+    // the first payload comes back from the releaser before the next read,
+    // so at least one read is served from the pool however threads are run
+    while (i == 0 && released.load() == 0) {
+      std::this_thread::yield();
+    }
+  }
+  writer.join();
+  reading.store(false);
+  releaser.join();
+  {
+    // whatever was handed off after the releaser's last swap
+    std::lock_guard<std::mutex> guard(lock);
+    for (IpcEntry &entry : handed_off) {
+      size_t value;
+      memcpy(&value, entry.payload, sizeof(value));
+      sum += value;
+      ipc_entry_release(&entry);
+    }
+  }
+
+  CHECK(sum == total * (total - 1) / 2);
+  const IpcPayloadPoolStats stats = ipc_channel_get_payload_pool_stats(channel);
+  CHECK(stats.hits + stats.misses == total);
+  CHECK(stats.hits > 0);
+  ipc_channel_destroy(channel);
+}
@@ -1,8 +1,12 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest/doctest.h"
+#include "shmipc/ipc_init.h"
 #include "shmipc/ipc_mmap.h"
 #include "test_utils.h"
+#include <cstring>
+#include <sys/mman.h>
 #include <unistd.h>
+#include <vector>
 
 TEST_CASE("different segment sizes") {
     const char name[] = "/test";
@@ -17,3 +21,132 @@ TEST_CASE("different segment sizes") {
     CHECK(ipc_unlink(created_segment.result).ipc_status == IPC_OK);
     CHECK(diff_size_segment.ipc_status == IPC_ERR_ILLEGAL_STATE);
 }
+
+TEST_CASE("mirrored segment aliases the data region") {
+  const char name[] = "/test_mirrored";
+  const uint64_t page_size = (uint64_t)sysconf(_SC_PAGESIZE);
+
+  const IpcMemorySegmentResult invalid =
+      ipc_mmap_mirrored(name, 64, page_size + 8);
+  CHECK(invalid.ipc_status == IPC_ERR_INVALID_ARGUMENT);
+
+  const IpcMemorySegmentResult segment = ipc_mmap_mirrored(name, 64, page_size);
+  REQUIRE(IpcMemorySegmentResult_is_ok(segment));
+  CHECK(segment.result->size == 64 + page_size);
+
+  uint8_t *data = (uint8_t *)segment.result->memory + 64;
+  data[0] = 42;
+  data[page_size - 1] = 7;
+  CHECK(data[page_size] == 42);
+  data[page_size + 1] = 9;
+  CHECK(data[1] == 9);
+
+  CHECK(ipc_unlink(segment.result).ipc_status == IPC_OK);
+}
+
+TEST_CASE("mirrored buffer writes entries across the wrap point") {
+  const char name[] = "/test_mirrored_buffer";
+  const uint64_t page_size = (uint64_t)sysconf(_SC_PAGESIZE);
+  const uint64_t overhead = ipc_buffer_get_memory_overhead();
+
+  const IpcMemorySegmentResult segment =
+      ipc_mmap_mirrored(name, overhead, page_size);
+  REQUIRE(IpcMemorySegmentResult_is_ok(segment));
+
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_MIRRORED,
+                                    .subscribers = 0};
+  const IpcBufferCreateResult created = ipc_buffer_create_with_options(
+      segment.result->memory, overhead + page_size, &options);
+  REQUIRE(IpcBufferCreateResult_is_ok(created));
+  IpcBuffer *buffer = created.result;
+
+  // leave 16 bytes before the wrap point, too little for the next entry
+  std::vector<uint8_t> filler(page_size - 16 - 24);
+  test_utils::CHECK_OK(ipc_buffer_write(buffer, filler.data(), filler.size()));
+  test_utils::EntryWrapper first(filler.size());
+  IpcEntry entry = first.get();
+  test_utils::CHECK_OK(ipc_buffer_read(buffer, &entry));
+
+  std::vector<uint8_t> msg(100);
+  for (size_t i = 0; i < msg.size(); i++) {
+    msg[i] = (uint8_t)i;
+  }
+  test_utils::CHECK_OK(ipc_buffer_write(buffer, msg.data(), msg.size()));
+
+  test_utils::EntryWrapper second(msg.size());
+  entry = second.get();
+  const IpcBufferReadResult read = ipc_buffer_read(buffer, &entry);
+  test_utils::CHECK_OK(read);
+  CHECK(read.ipc_status == IPC_OK);
+  CHECK(entry.offset == page_size - 16);
+  CHECK(entry.size == msg.size());
+  CHECK(std::memcmp(entry.payload, msg.data(), msg.size()) == 0);
+
+  free(buffer);
+  CHECK(ipc_unlink(segment.result).ipc_status == IPC_OK);
+}
+
+TEST_CASE("mirrored channel through init") {
+  const char name[] = "/test_mirrored_channel";
+  const uint64_t page_size = (uint64_t)sysconf(_SC_PAGESIZE);
+  const size_t size = ipc_channel_get_memory_overhead() + page_size;
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_MIRRORED,
+                                    .subscribers = 0};
+
+  const IpcInitChannelOpenResult created =
+      ipc_init_channel_create_with_options(name, size, &options);
+  REQUIRE(IpcInitChannelOpenResult_is_ok(created));
+
+  const IpcInitChannelConnectResult plain =
+      ipc_init_channel_connect(name, size);
+  CHECK(plain.ipc_status == IPC_ERR_ILLEGAL_STATE);
+
+  const IpcInitChannelConnectResult connected =
+      ipc_init_channel_connect_with_options(name, size, &options);
+  REQUIRE(IpcInitChannelConnectResult_is_ok(connected));
+
+  // every write crosses the wrap point at some lap, none of them may fail
+  const struct timespec timeout = {.tv_sec = 1, .tv_nsec = 0};
+  std::vector<uint8_t> msg(200);
+  for (uint64_t i = 0; i < 3 * page_size / 208; i++) {
+    std::memset(msg.data(), (int)(i & 0xFF), msg.size());
+    test_utils::CHECK_OK(
+        ipc_channel_write(created.result, msg.data(), msg.size()));
+
+    test_utils::EntryWrapper wrapper(msg.size());
+    IpcEntry entry = wrapper.get();
+    const IpcChannelReadResult read =
+        ipc_channel_read(connected.result, &entry, &timeout);
+    REQUIRE(IpcChannelReadResult_is_ok(read));
+    CHECK(entry.size == msg.size());
+    CHECK(std::memcmp(entry.payload, msg.data(), msg.size()) == 0);
+  }
+
+  ipc_channel_destroy(connected.result);
+  ipc_channel_destroy(created.result);
+  shm_unlink(name);
+}
+
+TEST_CASE("mirrored channel refuses a single mapping") {
+  const char name[] = "/test_mirrored_single";
+  const size_t size = ipc_channel_suggest_size(256);
+  const IpcBufferOptions options = {.flags = IPC_BUFFER_MIRRORED,
+                                    .subscribers = 0};
+
+  // a mirrored header in a plain mapping, as a size-matched connect without
+  // options would see it
+  const IpcMemorySegmentResult segment = ipc_mmap(name, size);
+  REQUIRE(IpcMemorySegmentResult_is_ok(segment));
+  const IpcChannelOpenResult created = ipc_channel_create_with_options(
+      segment.result->memory, size, &options);
+  REQUIRE(IpcChannelOpenResult_is_ok(created));
+  CHECK(ipc_channel_get_flags(created.result) == IPC_BUFFER_MIRRORED);
+
+  const IpcInitChannelConnectResult plain =
+      ipc_init_channel_connect(name, size);
+  CHECK(plain.ipc_status == IPC_ERR_ILLEGAL_STATE);
+
+  ipc_channel_destroy(created.result);
+  ipc_unmap(segment.result);
+  shm_unlink(name);
+}
@@ -0,0 +1,196 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+#include "shmipc/ipc_ring.h"
+#include "test_utils.h"
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+TEST_CASE("ring create - invalid arguments") {
+  uint8_t mem[1024];
+  test_utils::CHECK_ERROR(ipc_ring_create(nullptr, sizeof(mem), 8),
+                          IPC_ERR_INVALID_ARGUMENT);
+  test_utils::CHECK_ERROR(ipc_ring_create(mem, sizeof(mem), 0),
+                          IPC_ERR_INVALID_ARGUMENT);
+
+  const IpcRingCreateResult small =
+      ipc_ring_create(mem, ipc_ring_get_memory_overhead(), 8);
+  test_utils::CHECK_ERROR(small, IPC_ERR_INVALID_ARGUMENT);
+  CHECK(small.error.body.min_size > ipc_ring_get_memory_overhead());
+}
+
+TEST_CASE("ring create - capacity is power of 2") {
+  const size_t size = ipc_ring_suggest_size(24, 5);
+  std::vector<uint8_t> mem(size + 16);
+
+  const IpcRingCreateResult result = ipc_ring_create(mem.data(), size, 24);
+  test_utils::CHECK_OK(result);
+  CHECK(ipc_ring_get_capacity(result.result) == 8);
+  CHECK(ipc_ring_get_slot_size(result.result) == 24);
+  free(result.result);
+}
+
+TEST_CASE("ring write and read") {
+  std::vector<uint8_t> mem(ipc_ring_suggest_size(16, 4));
+  const IpcRingCreateResult created =
+      ipc_ring_create(mem.data(), mem.size(), 16);
+  test_utils::CHECK_OK(created);
+  IpcRing *ring = created.result;
+
+  const char msg[] = "hello";
+  test_utils::CHECK_OK(ipc_ring_write(ring, msg, sizeof(msg)));
+
+  test_utils::EntryWrapper entry(16);
+  IpcEntry dest = entry.get();
+  const IpcRingReadResult read = ipc_ring_read(ring, &dest);
+  test_utils::CHECK_OK(read);
+  CHECK(read.ipc_status == IPC_OK);
+  CHECK(dest.offset == 0);
+  CHECK(dest.size == sizeof(msg));
+  CHECK(std::memcmp(dest.payload, msg, sizeof(msg)) == 0);
+
+  dest = entry.get();
+  const IpcRingReadResult empty = ipc_ring_read(ring, &dest);
+  test_utils::CHECK_OK(empty);
+  CHECK(empty.ipc_status == IPC_EMPTY);
+  free(ring);
+}
+
+TEST_CASE("ring write - invalid and too large entries") {
+  std::vector<uint8_t> mem(ipc_ring_suggest_size(8, 2));
+  IpcRing *ring = ipc_ring_create(mem.data(), mem.size(), 8).result;
+
+  const uint8_t data[16] = {0};
+  test_utils::CHECK_ERROR(ipc_ring_write(nullptr, data, 4),
+                          IPC_ERR_INVALID_ARGUMENT);
+  test_utils::CHECK_ERROR(ipc_ring_write(ring, nullptr, 4),
+                          IPC_ERR_INVALID_ARGUMENT);
+  test_utils::CHECK_ERROR(ipc_ring_write(ring, data, 0),
+                          IPC_ERR_INVALID_ARGUMENT);
+
+  const IpcRingWriteResult large = ipc_ring_write(ring, data, sizeof(data));
+  test_utils::CHECK_ERROR(large, IPC_ERR_ENTRY_TOO_LARGE);
+  CHECK(large.error.body.slot_size == 8);
+  free(ring);
+}
+
+TEST_CASE("ring write - full ring") {
+  std::vector<uint8_t> mem(ipc_ring_suggest_size(8, 4));
+  IpcRing *ring = ipc_ring_create(mem.data(), mem.size(), 8).result;
+  REQUIRE(ipc_ring_get_capacity(ring) == 4);
+
+  for (uint64_t i = 0; i < 4; i++) {
+    test_utils::CHECK_OK(ipc_ring_write(ring, &i, sizeof(i)));
+  }
+
+  const uint64_t extra = 4;
+  const IpcRingWriteResult full = ipc_ring_write(ring, &extra, sizeof(extra));
+  test_utils::CHECK_ERROR(full, IPC_ERR_NO_SPACE_CONTIGUOUS);
+  CHECK(full.error.body.offset == 4);
+
+  uint64_t value = 0;
+  IpcEntry dest = {.offset = 0, .payload = &value, .size = sizeof(value)};
+  test_utils::CHECK_OK(ipc_ring_read(ring, &dest));
+  CHECK(value == 0);
+
+  test_utils::CHECK_OK(ipc_ring_write(ring, &extra, sizeof(extra)));
+  for (uint64_t i = 1; i <= 4; i++) {
+    dest = {.offset = 0, .payload = &value, .size = sizeof(value)};
+    test_utils::CHECK_OK(ipc_ring_read(ring, &dest));
+    CHECK(dest.offset == i);
+    CHECK(value == i);
+  }
+  free(ring);
+}
+
+TEST_CASE("ring read - destination too small keeps entry") {
+  std::vector<uint8_t> mem(ipc_ring_suggest_size(32, 2));
+  IpcRing *ring = ipc_ring_create(mem.data(), mem.size(), 32).result;
+
+  const char msg[] = "longer than four";
+  test_utils::CHECK_OK(ipc_ring_write(ring, msg, sizeof(msg)));
+
+  test_utils::EntryWrapper small(4);
+  IpcEntry dest = small.get();
+  const IpcRingReadResult too_small = ipc_ring_read(ring, &dest);
+  test_utils::CHECK_ERROR(too_small, IPC_ERR_TOO_SMALL);
+  CHECK(too_small.error.body.required_size == sizeof(msg));
+
+  test_utils::EntryWrapper large(32);
+  dest = large.get();
+  test_utils::CHECK_OK(ipc_ring_read(ring, &dest));
+  CHECK(std::memcmp(dest.payload, msg, sizeof(msg)) == 0);
+  free(ring);
+}
+
+TEST_CASE("ring attach") {
+  std::vector<uint8_t> mem(ipc_ring_suggest_size(8, 4));
+  test_utils::CHECK_ERROR(ipc_ring_attach(nullptr), IPC_ERR_INVALID_ARGUMENT);
+  test_utils::CHECK_ERROR(ipc_ring_attach(mem.data()), IPC_ERR_ILLEGAL_STATE);
+
+  IpcRing *ring = ipc_ring_create(mem.data(), mem.size(), 8).result;
+  const uint64_t value = 42;
+  test_utils::CHECK_OK(ipc_ring_write(ring, &value, sizeof(value)));
+
+  const IpcRingAttachResult attached = ipc_ring_attach(mem.data());
+  test_utils::CHECK_OK(attached);
+  CHECK(ipc_ring_get_capacity(attached.result) == 4);
+  CHECK(ipc_ring_get_slot_size(attached.result) == 8);
+
+  uint64_t read_value = 0;
+  IpcEntry dest = {.offset = 0, .payload = &read_value, .size = 8};
+  test_utils::CHECK_OK(ipc_ring_read(attached.result, &dest));
+  CHECK(read_value == value);
+  free(attached.result);
+  free(ring);
+}
+
+TEST_CASE("ring - multiple producers multiple consumers") {
+  constexpr size_t producers = 2;
+  constexpr size_t consumers = 2;
+  constexpr uint64_t per_producer = 20000;
+
+  std::vector<uint8_t> mem(ipc_ring_suggest_size(sizeof(uint64_t), 64));
+  IpcRing *ring =
+      ipc_ring_create(mem.data(), mem.size(), sizeof(uint64_t)).result;
+
+  std::atomic<uint64_t> consumed{0};
+  std::atomic<uint64_t> sum{0};
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; p++) {
+    threads.emplace_back([ring, p] {
+      for (uint64_t i = 0; i < per_producer; i++) {
+        const uint64_t value = p * per_producer + i;
+        while (IpcRingWriteResult_is_error(
+            ipc_ring_write(ring, &value, sizeof(value)))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (size_t c = 0; c < consumers; c++) {
+    threads.emplace_back([ring, &consumed, &sum] {
+      while (consumed.load() < producers * per_producer) {
+        uint64_t value = 0;
+        IpcEntry dest = {.offset = 0, .payload = &value, .size = 8};
+        const IpcRingReadResult read = ipc_ring_read(ring, &dest);
+        if (read.ipc_status == IPC_OK) {
+          sum.fetch_add(value);
+          consumed.fetch_add(1);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  const uint64_t total = producers * per_producer;
+  CHECK(consumed.load() == total);
+  CHECK(sum.load() == total * (total - 1) / 2);
+  free(ring);
+}
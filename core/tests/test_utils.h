@@ -4,6 +4,7 @@
 #include "shmipc/ipc_buffer.h"
 #include "shmipc/ipc_channel.h"
 #include "shmipc/ipc_common.h"
+#include "shmipc/ipc_ring.h"
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
@@ -21,9 +22,11 @@ constexpr size_t LARGE_COUNT = 50000;
 
 class BufferWrapper {
 public:
-  explicit BufferWrapper(size_t size) : mem_(ipc_buffer_suggest_size(size)) {
-    const IpcBufferCreateResult result =
-        ipc_buffer_create(mem_.data(), ipc_buffer_suggest_size(size));
+  explicit BufferWrapper(size_t size, uint32_t flags = 0)
+      : mem_(ipc_buffer_suggest_size(size)) {
+    const IpcBufferOptions options = {.flags = flags, .subscribers = 0};
+    const IpcBufferCreateResult result = ipc_buffer_create_with_options(
+        mem_.data(), ipc_buffer_suggest_size(size), &options);
     CHECK(IpcBufferCreateResult_is_ok(result));
     buffer_ = result.result;
   }
@@ -56,9 +59,11 @@ private:
 
 class ChannelWrapper {
 public:
-  explicit ChannelWrapper(size_t size) : mem_(ipc_channel_suggest_size(size)) {
-    const IpcChannelOpenResult result =
-        ipc_channel_create(mem_.data(), ipc_channel_suggest_size(size));
+  explicit ChannelWrapper(size_t size, uint32_t flags = 0)
+      : mem_(ipc_channel_suggest_size(size)) {
+    const IpcBufferOptions options = {.flags = flags, .subscribers = 0};
+    const IpcChannelOpenResult result = ipc_channel_create_with_options(
+        mem_.data(), ipc_channel_suggest_size(size), &options);
     CHECK(IpcChannelOpenResult_is_ok(result));
     channel_ = result.result;
   }
@@ -199,6 +204,116 @@ inline void CHECK_ERROR(const IpcBufferWriteResult &result,
   CHECK(result.ipc_status == expected_status);
 }
 
+inline void CHECK_OK(const IpcBufferWritevResult &result) {
+  CHECK(IpcBufferWritevResult_is_ok(result));
+}
+
+inline void CHECK_ERROR(const IpcBufferWritevResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcBufferWritevResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
+inline void CHECK_OK(const IpcBufferWriteBatchResult &result) {
+  CHECK(IpcBufferWriteBatchResult_is_ok(result));
+}
+
+inline void CHECK_ERROR(const IpcBufferWriteBatchResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcBufferWriteBatchResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
+inline void CHECK_OK(const IpcBufferReserveResult &result) {
+  CHECK(IpcBufferReserveResult_is_ok(result));
+}
+
+inline void CHECK_ERROR(const IpcBufferReserveResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcBufferReserveResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
+inline void CHECK_OK(const IpcBufferCommitResult &result) {
+  CHECK(IpcBufferCommitResult_is_ok(result));
+}
+
+inline void CHECK_ERROR(const IpcBufferCommitResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcBufferCommitResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
+inline void CHECK_OK(const IpcBufferAbortResult &result) {
+  CHECK(IpcBufferAbortResult_is_ok(result));
+}
+
+inline void CHECK_ERROR(const IpcBufferAbortResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcBufferAbortResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
+inline void CHECK_OK(const IpcBufferReadBatchResult &result) {
+  CHECK(result.ipc_status == IPC_OK);
+}
+
+inline void CHECK_ERROR(const IpcBufferReadBatchResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcBufferReadBatchResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
+inline void CHECK_OK(const IpcBufferAcquireResult &result) {
+  CHECK(result.ipc_status == IPC_OK);
+}
+
+inline void CHECK_ERROR(const IpcBufferAcquireResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcBufferAcquireResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
+inline void CHECK_OK(const IpcBufferReleaseResult &result) {
+  CHECK(IpcBufferReleaseResult_is_ok(result));
+}
+
+inline void CHECK_ERROR(const IpcBufferReleaseResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcBufferReleaseResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
+inline void CHECK_OK(const IpcBufferSubscribeResult &result) {
+  CHECK(IpcBufferSubscribeResult_is_ok(result));
+}
+
+inline void CHECK_ERROR(const IpcBufferSubscribeResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcBufferSubscribeResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
+inline void CHECK_OK(const IpcBufferJoinGroupResult &result) {
+  CHECK(IpcBufferJoinGroupResult_is_ok(result));
+}
+
+inline void CHECK_ERROR(const IpcBufferJoinGroupResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcBufferJoinGroupResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
+inline void CHECK_OK(const IpcBufferUnsubscribeResult &result) {
+  CHECK(IpcBufferUnsubscribeResult_is_ok(result));
+}
+
+inline void CHECK_ERROR(const IpcBufferUnsubscribeResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcBufferUnsubscribeResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
 inline void CHECK_OK(const IpcBufferReadResult &result) {
   CHECK(result.ipc_status == IPC_OK);
 }
@@ -219,6 +334,46 @@ inline void CHECK_ERROR(const IpcBufferPeekResult &result,
   CHECK(result.ipc_status == expected_status);
 }
 
+inline void CHECK_OK(const IpcRingCreateResult &result) {
+  CHECK(IpcRingCreateResult_is_ok(result));
+}
+
+inline void CHECK_ERROR(const IpcRingCreateResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcRingCreateResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
+inline void CHECK_OK(const IpcRingAttachResult &result) {
+  CHECK(IpcRingAttachResult_is_ok(result));
+}
+
+inline void CHECK_ERROR(const IpcRingAttachResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcRingAttachResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
+inline void CHECK_OK(const IpcRingWriteResult &result) {
+  CHECK(IpcRingWriteResult_is_ok(result));
+}
+
+inline void CHECK_ERROR(const IpcRingWriteResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcRingWriteResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
+inline void CHECK_OK(const IpcRingReadResult &result) {
+  CHECK(IpcRingReadResult_is_ok(result));
+}
+
+inline void CHECK_ERROR(const IpcRingReadResult &result,
+                        IpcStatus expected_status) {
+  CHECK(IpcRingReadResult_is_error(result));
+  CHECK(result.ipc_status == expected_status);
+}
+
 inline void CHECK_OK(const IpcChannelOpenResult &result) {
   CHECK(IpcChannelOpenResult_is_ok(result));
 }
@@ -3,6 +3,7 @@
 #include <shmipc/ipc_common.h>
 #include <shmipc/ipc_export.h>
 #include <stdbool.h>
+#include <sys/uio.h>
 
 SHMIPC_BEGIN_DECLS
 
@@ -12,6 +13,46 @@ SHMIPC_API uint64_t ipc_buffer_get_memory_overhead(void);
 SHMIPC_API uint64_t ipc_buffer_get_min_size(void);
 SHMIPC_API uint64_t ipc_buffer_suggest_size(size_t desired_capacity);
 
+// Producers claim space with a single atomic advance of the tail and
+// publish every entry separately, so writers copy in parallel. Consumers pay
+// for it by poisoning every entry they release.
+#define IPC_BUFFER_CONCURRENT_WRITE 0x1u
+// Exactly one producer and one consumer: head and tail are owned by their
+// sides and advanced with release stores, no lock bit and no CAS.
+#define IPC_BUFFER_SPSC 0x2u
+// Any number of producers, exactly one consumer: producers keep their tail
+// protocol, the consumer owns the head and advances it with a release store.
+#define IPC_BUFFER_MPSC 0x4u
+// 8-byte entry header (32-bit offset tag + 32-bit length) instead of 24
+// bytes, for rings of small messages. Limits the buffer to 2 GiB.
+#define IPC_BUFFER_COMPACT_ENTRIES 0x8u
+// The data region is mapped a second time right behind itself (see
+// ipc_mmap_mirrored), entries run across the wrap point and no placeholders
+// are written.
+#define IPC_BUFFER_MIRRORED 0x10u
+// One tail, one cursor per subscriber: every subscriber reads every entry and
+// the writer is gated by the slowest one. Cursor slots sit in their own cache
+// lines between the header and the data, see ipc_buffer_subscribe.
+#define IPC_BUFFER_BROADCAST 0x20u
+// A full ring never fails a writer, batches included: it moves the head past
+// the oldest entries and reuses their space. Reads detect an entry overwritten
+// under them and resync to the oldest one left, ipc_buffer_read_lossy reports
+// how many were lost. Zero-copy views can not be protected: peek reports the
+// next entry without a payload, acquire and read_batch fail with
+// IPC_ERR_INVALID_ARGUMENT.
+#define IPC_BUFFER_OVERWRITE 0x40u
+
+typedef struct IpcBufferOptions {
+  uint32_t flags;
+  // cursor slots reserved for IPC_BUFFER_BROADCAST
+  uint32_t subscribers;
+} IpcBufferOptions;
+
+SHMIPC_API uint64_t
+ipc_buffer_get_memory_overhead_with_options(const IpcBufferOptions *options);
+SHMIPC_API uint64_t ipc_buffer_suggest_size_with_options(
+    size_t desired_capacity, const IpcBufferOptions *options);
+
 typedef struct IpcBufferCreateError {
   size_t requested_size;
   size_t min_size;
@@ -20,6 +61,8 @@ typedef struct IpcBufferCreateError {
 IPC_RESULT(IpcBufferCreateResult, IpcBuffer *, IpcBufferCreateError)
 SHMIPC_API IpcBufferCreateResult ipc_buffer_create(void *mem,
                                                    const size_t size);
+SHMIPC_API IpcBufferCreateResult ipc_buffer_create_with_options(
+    void *mem, const size_t size, const IpcBufferOptions *options);
 
 typedef struct IpcBufferAttachError {
   size_t min_size;
@@ -27,6 +70,42 @@ typedef struct IpcBufferAttachError {
 } IpcBufferAttachError;
 IPC_RESULT(IpcBufferAttachResult, IpcBuffer *, IpcBufferAttachError)
 SHMIPC_API IpcBufferAttachResult ipc_buffer_attach(void *mem);
+// fails with IPC_ERR_ILLEGAL_STATE unless the buffer was created in the same
+// mode
+SHMIPC_API IpcBufferAttachResult
+ipc_buffer_attach_with_options(void *mem, const IpcBufferOptions *options);
+
+// IPC_BUFFER_* flags the buffer was created with, 0 for NULL
+SHMIPC_API uint32_t ipc_buffer_get_flags(const IpcBuffer *buffer);
+
+typedef struct IpcBufferSubscribeError {
+  uint32_t subscribers;
+} IpcBufferSubscribeError;
+// result is the claimed cursor slot. The subscriber starts at the current
+// tail; reads on a broadcast buffer fail until the handle is subscribed.
+IPC_RESULT(IpcBufferSubscribeResult, uint32_t, IpcBufferSubscribeError)
+SHMIPC_API IpcBufferSubscribeResult ipc_buffer_subscribe(IpcBuffer *buffer);
+
+// including the terminating NUL
+#define IPC_BUFFER_GROUP_NAME_MAX 48
+
+typedef struct IpcBufferJoinGroupError {
+  uint32_t subscribers;
+} IpcBufferJoinGroupError;
+// Joins the named consumer group, creating it at the current tail if it does
+// not exist yet. A group takes one cursor slot: its members split the entries
+// with the usual head lock, every group sees every entry.
+IPC_RESULT(IpcBufferJoinGroupResult, uint32_t, IpcBufferJoinGroupError)
+SHMIPC_API IpcBufferJoinGroupResult ipc_buffer_join_group(IpcBuffer *buffer,
+                                                          const char *name);
+
+// leaves the group as well, the last member to leave frees its slot
+typedef struct IpcBufferUnsubscribeError {
+  bool _unit;
+} IpcBufferUnsubscribeError;
+IPC_RESULT_UNIT(IpcBufferUnsubscribeResult, IpcBufferUnsubscribeError)
+SHMIPC_API IpcBufferUnsubscribeResult
+ipc_buffer_unsubscribe(IpcBuffer *buffer);
 
 typedef struct IpcBufferWriteError {
   uint64_t offset;
@@ -41,6 +120,58 @@ SHMIPC_API IpcBufferWriteResult ipc_buffer_write(IpcBuffer *buffer,
                                                  const void *data,
                                                  const size_t size);
 
+typedef struct IpcBufferWritevError {
+  uint64_t offset;
+  size_t requested_size;
+  size_t required_size;
+  size_t free_space;
+  size_t available_contiguous;
+  size_t buffer_size;
+} IpcBufferWritevError;
+IPC_RESULT_UNIT(IpcBufferWritevResult, IpcBufferWritevError)
+SHMIPC_API IpcBufferWritevResult ipc_buffer_writev(IpcBuffer *buffer,
+                                                   const struct iovec *iov,
+                                                   const int iovcnt);
+
+typedef struct IpcBufferWriteBatchError {
+  uint64_t offset;
+  size_t index;
+  size_t required_size;
+  size_t free_space;
+  size_t buffer_size;
+} IpcBufferWriteBatchError;
+// result is the number of leading messages written, the rest did not fit
+IPC_RESULT(IpcBufferWriteBatchResult, size_t, IpcBufferWriteBatchError)
+SHMIPC_API IpcBufferWriteBatchResult ipc_buffer_write_batch(
+    IpcBuffer *buffer, const IpcMessage *messages, const size_t count);
+
+typedef struct IpcBufferReserveError {
+  uint64_t offset;
+  size_t requested_size;
+  size_t required_size;
+  size_t free_space;
+  size_t available_contiguous;
+  size_t buffer_size;
+} IpcBufferReserveError;
+IPC_RESULT_UNIT(IpcBufferReserveResult, IpcBufferReserveError)
+SHMIPC_API IpcBufferReserveResult ipc_buffer_reserve(IpcBuffer *buffer,
+                                                     const size_t size,
+                                                     IpcSlot *slot);
+
+typedef struct IpcBufferCommitError {
+  uint64_t offset;
+} IpcBufferCommitError;
+IPC_RESULT_UNIT(IpcBufferCommitResult, IpcBufferCommitError)
+SHMIPC_API IpcBufferCommitResult ipc_buffer_commit(IpcBuffer *buffer,
+                                                   const IpcSlot *slot);
+
+typedef struct IpcBufferAbortError {
+  uint64_t offset;
+} IpcBufferAbortError;
+IPC_RESULT_UNIT(IpcBufferAbortResult, IpcBufferAbortError)
+SHMIPC_API IpcBufferAbortResult ipc_buffer_abort(IpcBuffer *buffer,
+                                                 const IpcSlot *slot);
+
 typedef struct IpcBufferReadError {
   uint64_t offset;
   size_t required_size;
@@ -48,6 +179,33 @@ typedef struct IpcBufferReadError {
 IPC_RESULT_UNIT(IpcBufferReadResult, IpcBufferReadError)
 SHMIPC_API IpcBufferReadResult ipc_buffer_read(IpcBuffer *buffer,
                                                IpcEntry *dest);
+// Like ipc_buffer_read, lost receives the number of entries overwritten since
+// this handle last asked, always 0 without IPC_BUFFER_OVERWRITE. It is set
+// whenever the read does not fail, IPC_EMPTY included.
+SHMIPC_API IpcBufferReadResult ipc_buffer_read_lossy(IpcBuffer *buffer,
+                                                     IpcEntry *dest,
+                                                     uint64_t *lost);
+
+// Returns a destination of at least size bytes, NULL when there is none.
+typedef void *(*IpcPayloadSizer)(size_t size, void *ctx);
+// Like ipc_buffer_read, but the destination comes from sizer once the entry
+// is claimed, so a caller does not need to peek for its size first. sizer
+// runs while the head is held and again when the read has to start over;
+// IPC_ERR_SYSTEM with the entry left in place when it returns NULL.
+SHMIPC_API IpcBufferReadResult ipc_buffer_read_sized(IpcBuffer *buffer,
+                                                     IpcEntry *dest,
+                                                     IpcPayloadSizer sizer,
+                                                     void *ctx);
+
+typedef struct IpcBufferReadBatchError {
+  uint64_t offset;
+} IpcBufferReadBatchError;
+// result is the number of entries passed to the callback, payloads are valid
+// only during the callback
+IPC_RESULT(IpcBufferReadBatchResult, size_t, IpcBufferReadBatchError)
+SHMIPC_API IpcBufferReadBatchResult
+ipc_buffer_read_batch(IpcBuffer *buffer, const size_t max_entries,
+                      IpcEntryCallback callback, void *ctx);
 
 typedef struct IpcBufferPeekError {
   uint64_t offset;
@@ -56,6 +214,20 @@ IPC_RESULT_UNIT(IpcBufferPeekResult, IpcBufferPeekError)
 SHMIPC_API IpcBufferPeekResult ipc_buffer_peek(IpcBuffer *buffer,
                                                IpcEntry *dest);
 
+typedef struct IpcBufferAcquireError {
+  uint64_t offset;
+} IpcBufferAcquireError;
+IPC_RESULT_UNIT(IpcBufferAcquireResult, IpcBufferAcquireError)
+SHMIPC_API IpcBufferAcquireResult ipc_buffer_acquire(IpcBuffer *buffer,
+                                                     IpcEntry *dest);
+
+typedef struct IpcBufferReleaseError {
+  uint64_t offset;
+} IpcBufferReleaseError;
+IPC_RESULT_UNIT(IpcBufferReleaseResult, IpcBufferReleaseError)
+SHMIPC_API IpcBufferReleaseResult ipc_buffer_release(IpcBuffer *buffer,
+                                                     const IpcEntry *entry);
+
 typedef struct IpcBufferSkipError {
   uint64_t offset;
 } IpcBufferSkipError;
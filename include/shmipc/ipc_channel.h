@@ -1,5 +1,6 @@
 #pragma once
 
+#include <shmipc/ipc_buffer.h>
 #include <shmipc/ipc_common.h>
 #include <shmipc/ipc_export.h>
 #include <time.h>
@@ -11,6 +12,8 @@ typedef struct IpcChannel IpcChannel;
 SHMIPC_API uint64_t ipc_channel_get_memory_overhead(void);
 SHMIPC_API uint64_t ipc_channel_get_min_size(void);
 SHMIPC_API uint64_t ipc_channel_suggest_size(size_t desired_capacity);
+SHMIPC_API uint64_t ipc_channel_suggest_size_with_options(
+    size_t desired_capacity, const IpcBufferOptions *options);
 
 typedef struct IpcChannelOpenError {
   size_t requested_size;
@@ -20,6 +23,8 @@ typedef struct IpcChannelOpenError {
 IPC_RESULT(IpcChannelOpenResult, IpcChannel *, IpcChannelOpenError)
 SHMIPC_API IpcChannelOpenResult ipc_channel_create(void *mem,
                                                    const size_t size);
+SHMIPC_API IpcChannelOpenResult ipc_channel_create_with_options(
+    void *mem, const size_t size, const IpcBufferOptions *options);
 
 typedef struct IpcChannelConnectError {
   int sys_errno;
@@ -27,6 +32,121 @@ typedef struct IpcChannelConnectError {
 } IpcChannelConnectError;
 IPC_RESULT(IpcChannelConnectResult, IpcChannel *, IpcChannelConnectError)
 SHMIPC_API IpcChannelConnectResult ipc_channel_connect(void *mem);
+SHMIPC_API IpcChannelConnectResult
+ipc_channel_connect_with_options(void *mem, const IpcBufferOptions *options);
+
+// IPC_BUFFER_* flags the channel was created with, 0 for NULL
+SHMIPC_API uint32_t ipc_channel_get_flags(const IpcChannel *channel);
+
+typedef struct IpcChannelSubscribeError {
+  uint32_t subscribers;
+} IpcChannelSubscribeError;
+// broadcast channels only, see ipc_buffer_subscribe
+IPC_RESULT(IpcChannelSubscribeResult, uint32_t, IpcChannelSubscribeError)
+SHMIPC_API IpcChannelSubscribeResult
+ipc_channel_subscribe(IpcChannel *channel);
+
+typedef struct IpcChannelJoinGroupError {
+  uint32_t subscribers;
+} IpcChannelJoinGroupError;
+// see ipc_buffer_join_group, ipc_channel_unsubscribe leaves the group
+IPC_RESULT(IpcChannelJoinGroupResult, uint32_t, IpcChannelJoinGroupError)
+SHMIPC_API IpcChannelJoinGroupResult
+ipc_channel_join_group(IpcChannel *channel, const char *name);
+
+typedef struct IpcChannelUnsubscribeError {
+  bool _unit;
+} IpcChannelUnsubscribeError;
+IPC_RESULT_UNIT(IpcChannelUnsubscribeResult, IpcChannelUnsubscribeError)
+SHMIPC_API IpcChannelUnsubscribeResult
+ipc_channel_unsubscribe(IpcChannel *channel);
+
+// How blocking calls (read, drain, acquire, write_timed) wait between two
+// attempts. Spinning skips the futex round trip at the price of a core.
+typedef enum {
+  // park on the futex right away, the default
+  IPC_WAIT_FUTEX = 0,
+  // never leave user space, poll with a CPU pause hint in between
+  IPC_WAIT_BUSY_SPIN = 1,
+  // spin_limit polls, then sched_yield between polls
+  IPC_WAIT_SPIN_YIELD = 2,
+  // spin_limit polls, then park on the futex
+  IPC_WAIT_SPIN_FUTEX = 3,
+} IpcWaitKind;
+
+typedef struct IpcWaitStrategy {
+  IpcWaitKind kind;
+  uint32_t spin_limit;
+} IpcWaitStrategy;
+
+typedef struct IpcChannelSetWaitStrategyError {
+  bool _unit;
+} IpcChannelSetWaitStrategyError;
+IPC_RESULT_UNIT(IpcChannelSetWaitStrategyResult,
+                IpcChannelSetWaitStrategyError)
+// applies to this handle only, other processes keep their own strategy
+SHMIPC_API IpcChannelSetWaitStrategyResult ipc_channel_set_wait_strategy(
+    IpcChannel *channel, const IpcWaitStrategy *strategy);
+
+// Payload pool: ipc_channel_read and ipc_channel_try_read on this handle take
+// payloads from size classes of recycled buffers instead of malloc. Such
+// entries must be handed back with ipc_entry_release, never free. Up to
+// max_cached buffers are kept per size class. Enable it before the first
+// read; entries may still be released after ipc_channel_destroy.
+typedef struct IpcChannelEnablePayloadPoolError {
+  int sys_errno;
+} IpcChannelEnablePayloadPoolError;
+// IPC_ERR_ILLEGAL_STATE when the handle already has a pool
+IPC_RESULT_UNIT(IpcChannelEnablePayloadPoolResult,
+                IpcChannelEnablePayloadPoolError)
+SHMIPC_API IpcChannelEnablePayloadPoolResult
+ipc_channel_enable_payload_pool(IpcChannel *channel, const size_t max_cached);
+
+typedef struct IpcPayloadPoolStats {
+  // reads served from a recycled buffer
+  uint64_t hits;
+  // reads that had to allocate
+  uint64_t misses;
+} IpcPayloadPoolStats;
+// all zero without a pool
+SHMIPC_API IpcPayloadPoolStats
+ipc_channel_get_payload_pool_stats(const IpcChannel *channel);
+
+// Returns the payload of an entry read with a pool to it, resets the entry.
+SHMIPC_API void ipc_entry_release(IpcEntry *entry);
+
+// Readiness descriptor: an eventfd (Linux only) to hand to epoll/poll next to
+// sockets and timers instead of blocking in ipc_channel_read. One handle per
+// channel owns it, the handle closes it in ipc_channel_destroy. Producers in
+// other processes signal it through their own copy (pidfd_getfd), which needs
+// ptrace access to the owner's process. A producer without it leaves the
+// descriptor armed, from then on both calls below fail with IPC_ERR_SYSTEM and
+// that producer's errno until another handle takes the descriptor over. Owners
+// that can not rule this out poll with a timeout.
+//
+// Producers only signal an armed descriptor, and only once per arming:
+//   for (;;) {
+//     drain the channel with ipc_channel_try_read until IPC_EMPTY
+//     if (ipc_channel_arm_readiness(channel).result) continue; // raced
+//     epoll_wait(...);
+//   }
+typedef struct IpcChannelReadinessFdError {
+  int sys_errno;
+} IpcChannelReadinessFdError;
+// IPC_ERR_ILLEGAL_STATE when another handle owns the descriptor
+IPC_RESULT(IpcChannelReadinessFdResult, int, IpcChannelReadinessFdError)
+SHMIPC_API IpcChannelReadinessFdResult
+ipc_channel_get_readiness_fd(IpcChannel *channel);
+
+typedef struct IpcChannelArmReadinessError {
+  int sys_errno;
+} IpcChannelArmReadinessError;
+// Resets the descriptor and arms it. result is true when entries are already
+// waiting, then it is left unarmed and the caller drains again instead of
+// waiting on it.
+IPC_RESULT(IpcChannelArmReadinessResult, bool, IpcChannelArmReadinessError)
+SHMIPC_API IpcChannelArmReadinessResult
+ipc_channel_arm_readiness(IpcChannel *channel);
 
 typedef struct IpcChannelDestroyError {
   bool _unit;
@@ -44,6 +164,63 @@ IPC_RESULT_UNIT(IpcChannelWriteResult, IpcChannelWriteError)
 SHMIPC_API IpcChannelWriteResult ipc_channel_write(IpcChannel *channel,
                                                    const void *data,
                                                    const size_t size);
+// Waits up to timeout for consumers to free enough space instead of failing
+// with IPC_ERR_NO_SPACE_CONTIGUOUS, IPC_ERR_TIMEOUT once it runs out.
+SHMIPC_API IpcChannelWriteResult
+ipc_channel_write_timed(IpcChannel *channel, const void *data,
+                        const size_t size, const struct timespec *timeout);
+// The *_until variants take an absolute CLOCK_MONOTONIC deadline instead of
+// a timeout, so a caller retrying in a loop reads the clock once for all of
+// its attempts. IPC_ERR_TIMEOUT once the deadline passed.
+SHMIPC_API IpcChannelWriteResult
+ipc_channel_write_until(IpcChannel *channel, const void *data,
+                        const size_t size, const struct timespec *deadline);
+
+typedef struct IpcChannelWritevError {
+  uint64_t offset;
+  size_t requested_size;
+  size_t available_contiguous;
+  size_t buffer_size;
+} IpcChannelWritevError;
+IPC_RESULT_UNIT(IpcChannelWritevResult, IpcChannelWritevError)
+SHMIPC_API IpcChannelWritevResult ipc_channel_writev(IpcChannel *channel,
+                                                     const struct iovec *iov,
+                                                     const int iovcnt);
+
+typedef struct IpcChannelWriteBatchError {
+  uint64_t offset;
+  size_t index;
+  size_t required_size;
+  size_t buffer_size;
+} IpcChannelWriteBatchError;
+IPC_RESULT(IpcChannelWriteBatchResult, size_t, IpcChannelWriteBatchError)
+SHMIPC_API IpcChannelWriteBatchResult ipc_channel_write_batch(
+    IpcChannel *channel, const IpcMessage *messages, const size_t count);
+
+typedef struct IpcChannelReserveError {
+  uint64_t offset;
+  size_t requested_size;
+  size_t available_contiguous;
+  size_t buffer_size;
+} IpcChannelReserveError;
+IPC_RESULT_UNIT(IpcChannelReserveResult, IpcChannelReserveError)
+SHMIPC_API IpcChannelReserveResult ipc_channel_reserve(IpcChannel *channel,
+                                                       const size_t size,
+                                                       IpcSlot *slot);
+
+typedef struct IpcChannelCommitError {
+  uint64_t offset;
+} IpcChannelCommitError;
+IPC_RESULT_UNIT(IpcChannelCommitResult, IpcChannelCommitError)
+SHMIPC_API IpcChannelCommitResult ipc_channel_commit(IpcChannel *channel,
+                                                     const IpcSlot *slot);
+
+typedef struct IpcChannelAbortError {
+  uint64_t offset;
+} IpcChannelAbortError;
+IPC_RESULT_UNIT(IpcChannelAbortResult, IpcChannelAbortError)
+SHMIPC_API IpcChannelAbortResult ipc_channel_abort(IpcChannel *channel,
+                                                   const IpcSlot *slot);
 
 typedef struct IpcChannelReadError {
   uint64_t offset;
@@ -53,6 +230,22 @@ typedef struct IpcChannelReadError {
 IPC_RESULT_UNIT(IpcChannelReadResult, IpcChannelReadError)
 SHMIPC_API IpcChannelReadResult ipc_channel_read(
     IpcChannel *channel, IpcEntry *dest, const struct timespec *timeout);
+SHMIPC_API IpcChannelReadResult ipc_channel_read_until(
+    IpcChannel *channel, IpcEntry *dest, const struct timespec *deadline);
+
+typedef struct IpcChannelReadIntoError {
+  uint64_t offset;
+  size_t required_size;
+  struct timespec timeout_used;
+  int sys_errno;
+} IpcChannelReadIntoError;
+// Like ipc_channel_read, but copies into buf and never allocates; len is set
+// to the payload size. IPC_ERR_TOO_SMALL with required_size when the entry
+// does not fit in cap, the entry is then left in the channel.
+IPC_RESULT_UNIT(IpcChannelReadIntoResult, IpcChannelReadIntoError)
+SHMIPC_API IpcChannelReadIntoResult
+ipc_channel_read_into(IpcChannel *channel, void *buf, const size_t cap,
+                      size_t *len, const struct timespec *timeout);
 
 typedef struct IpcChannelTryReadError {
   uint64_t offset;
@@ -61,6 +254,57 @@ IPC_RESULT_UNIT(IpcChannelTryReadResult, IpcChannelTryReadError)
 SHMIPC_API IpcChannelTryReadResult ipc_channel_try_read(IpcChannel *channel,
                                                         IpcEntry *dest);
 
+// Waits until at least one of the channels has an entry to read, so one
+// thread can serve many channels. Bit i of ready_mask is set when channels[i]
+// is readable; result is how many are. Nothing is consumed, follow up with
+// ipc_channel_try_read. Sleeps on every channel's futex at once with
+// futex_waitv (Linux 5.16+), and polls with growing naps without it.
+#define IPC_CHANNEL_SELECT_MAX 64
+typedef struct IpcChannelSelectError {
+  // the channel that failed
+  size_t index;
+  struct timespec timeout_used;
+  int sys_errno;
+} IpcChannelSelectError;
+IPC_RESULT(IpcChannelSelectResult, size_t, IpcChannelSelectError)
+SHMIPC_API IpcChannelSelectResult
+ipc_channel_select(IpcChannel *const *channels, const size_t count,
+                   const struct timespec *timeout, uint64_t *ready_mask);
+SHMIPC_API IpcChannelSelectResult
+ipc_channel_select_until(IpcChannel *const *channels, const size_t count,
+                         const struct timespec *deadline, uint64_t *ready_mask);
+
+typedef struct IpcChannelDrainError {
+  uint64_t offset;
+  struct timespec timeout_used;
+  int sys_errno;
+} IpcChannelDrainError;
+IPC_RESULT(IpcChannelDrainResult, size_t, IpcChannelDrainError)
+SHMIPC_API IpcChannelDrainResult
+ipc_channel_drain(IpcChannel *channel, IpcEntryCallback callback, void *ctx,
+                  const size_t max_entries, const struct timespec *timeout);
+SHMIPC_API IpcChannelDrainResult ipc_channel_drain_until(
+    IpcChannel *channel, IpcEntryCallback callback, void *ctx,
+    const size_t max_entries, const struct timespec *deadline);
+
+typedef struct IpcChannelAcquireError {
+  uint64_t offset;
+  struct timespec timeout_used;
+  int sys_errno;
+} IpcChannelAcquireError;
+IPC_RESULT_UNIT(IpcChannelAcquireResult, IpcChannelAcquireError)
+SHMIPC_API IpcChannelAcquireResult ipc_channel_acquire(
+    IpcChannel *channel, IpcEntry *dest, const struct timespec *timeout);
+SHMIPC_API IpcChannelAcquireResult ipc_channel_acquire_until(
+    IpcChannel *channel, IpcEntry *dest, const struct timespec *deadline);
+
+typedef struct IpcChannelReleaseError {
+  uint64_t offset;
+} IpcChannelReleaseError;
+IPC_RESULT_UNIT(IpcChannelReleaseResult, IpcChannelReleaseError)
+SHMIPC_API IpcChannelReleaseResult ipc_channel_release(IpcChannel *channel,
+                                                       const IpcEntry *entry);
+
 typedef struct IpcChannelPeekError {
   uint64_t offset;
 } IpcChannelPeekError;
@@ -122,4 +122,17 @@ typedef struct IpcEntry {
   size_t size;
 } IpcEntry;
 
+typedef void (*IpcEntryCallback)(const IpcEntry *entry, void *ctx);
+
+typedef struct IpcSlot {
+  uint64_t offset;
+  void *payload;
+  size_t size;
+} IpcSlot;
+
+typedef struct IpcMessage {
+  const void *data;
+  size_t size;
+} IpcMessage;
+
 SHMIPC_END_DECLS
@@ -37,6 +37,10 @@ typedef struct IpcInitChannelOpenError {
 IPC_RESULT(IpcInitChannelOpenResult, IpcChannel *, IpcInitChannelOpenError)
 SHMIPC_API IpcInitChannelOpenResult ipc_init_channel_create(const char *path,
                                                             const size_t size);
+// IPC_BUFFER_MIRRORED maps the data region twice, see ipc_mmap_mirrored;
+// size - overhead must then be a multiple of the page size.
+SHMIPC_API IpcInitChannelOpenResult ipc_init_channel_create_with_options(
+    const char *path, const size_t size, const IpcBufferOptions *options);
 
 typedef struct IpcInitChannelConnectError {
   size_t requested_size;
@@ -48,5 +52,10 @@ IPC_RESULT(IpcInitChannelConnectResult, IpcChannel *,
            IpcInitChannelConnectError)
 SHMIPC_API IpcInitChannelConnectResult
 ipc_init_channel_connect(const char *path, const size_t size);
+// NULL options connect to any mode except a mirrored one, which fails with
+// IPC_ERR_ILLEGAL_STATE; broadcast channels are only sized correctly with
+// their creation options
+SHMIPC_API IpcInitChannelConnectResult ipc_init_channel_connect_with_options(
+    const char *path, const size_t size, const IpcBufferOptions *options);
 
 SHMIPC_END_DECLS
@@ -9,6 +9,9 @@ typedef struct IpcMemorySegment {
   char *name;
   uint64_t size;
   void *memory;
+  // whole mapping, larger than memory/size for a mirrored segment
+  void *mapping;
+  uint64_t mapping_size;
 } IpcMemorySegment;
 
 typedef struct IpcMmapError {
@@ -21,6 +24,13 @@ typedef struct IpcMmapError {
 IPC_RESULT(IpcMemorySegmentResult, IpcMemorySegment *, IpcMmapError)
 SHMIPC_API IpcMemorySegmentResult ipc_mmap(const char *path, uint64_t size);
 
+// Maps header_size bytes followed by data_size bytes whose pages are mapped a
+// second time right behind them: memory + header_size + data_size aliases
+// memory + header_size. data_size must be a multiple of the page size.
+SHMIPC_API IpcMemorySegmentResult ipc_mmap_mirrored(const char *path,
+                                                    uint64_t header_size,
+                                                    uint64_t data_size);
+
 typedef struct IpcMmapUnmapError {
   const char *name;
   uint64_t size;
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <shmipc/ipc_common.h>
+#include <shmipc/ipc_export.h>
+#include <stdbool.h>
+
+SHMIPC_BEGIN_DECLS
+
+// Ring of fixed-size slots, every slot carries its own sequence number
+// (Vyukov bounded MPMC queue). No lock bits, no placeholders: producers and
+// consumers each claim a position with one CAS on their cursor.
+typedef struct IpcRing IpcRing;
+
+SHMIPC_API uint64_t ipc_ring_get_memory_overhead(void);
+SHMIPC_API uint64_t ipc_ring_suggest_size(size_t slot_size,
+                                          size_t desired_capacity);
+
+typedef struct IpcRingCreateError {
+  size_t requested_size;
+  size_t min_size;
+  int sys_errno;
+} IpcRingCreateError;
+IPC_RESULT(IpcRingCreateResult, IpcRing *, IpcRingCreateError)
+SHMIPC_API IpcRingCreateResult ipc_ring_create(void *mem, const size_t size,
+                                               const size_t slot_size);
+
+typedef struct IpcRingAttachError {
+  size_t min_size;
+  int sys_errno;
+} IpcRingAttachError;
+IPC_RESULT(IpcRingAttachResult, IpcRing *, IpcRingAttachError)
+SHMIPC_API IpcRingAttachResult ipc_ring_attach(void *mem);
+
+SHMIPC_API uint64_t ipc_ring_get_capacity(const IpcRing *ring);
+SHMIPC_API uint64_t ipc_ring_get_slot_size(const IpcRing *ring);
+
+typedef struct IpcRingWriteError {
+  uint64_t offset;
+  size_t requested_size;
+  size_t slot_size;
+} IpcRingWriteError;
+IPC_RESULT_UNIT(IpcRingWriteResult, IpcRingWriteError)
+SHMIPC_API IpcRingWriteResult ipc_ring_write(IpcRing *ring, const void *data,
+                                             const size_t size);
+
+typedef struct IpcRingReadError {
+  uint64_t offset;
+  size_t required_size;
+} IpcRingReadError;
+IPC_RESULT_UNIT(IpcRingReadResult, IpcRingReadError)
+SHMIPC_API IpcRingReadResult ipc_ring_read(IpcRing *ring, IpcEntry *dest);
+
+SHMIPC_END_DECLS